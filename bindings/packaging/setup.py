@@ -8,5 +8,5 @@ setuptools.setup(
     url="baslerweb.com",
     packages=[''],
     package_data={'': ['pygstpylon.so']},
-    install_requires=["pgi", "PyGObject"]
+    install_requires=["pgi", "PyGObject", "numpy"]
 )
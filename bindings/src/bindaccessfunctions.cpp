@@ -33,6 +33,15 @@
 #include "bindaccessfunctions.h"
 
 #include <gst/pylon/gstpylonmeta.h>
+#include <gst/video/video.h>
+#include <pybind11/numpy.h>
+#include <pybind11/stl.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <string>
+#include <vector>
 
 namespace py = pybind11;
 using namespace pybind11::literals;
@@ -40,6 +49,371 @@ using namespace std;
 
 namespace pygstpylon {
 
+/* Keeps the buffer referenced and mapped while a NumPy view exists */
+struct BufferMapping {
+  GstBuffer *buffer;
+  GstMapInfo info;
+};
+
+static void buffer_mapping_free(void *data) {
+  auto mapping = static_cast<BufferMapping *>(data);
+
+  gst_buffer_unmap(mapping->buffer, &mapping->info);
+  gst_buffer_unref(mapping->buffer);
+  delete mapping;
+}
+
+/* Sample size of Bayer caps, 8 bit formats like "rggb" have no suffix,
+ * wider ones end in their depth and endianness, e.g. "rggb12le" */
+static gsize bayer_get_sample_size(const GstStructure *st,
+                                   bool *little_endian) {
+  const gchar *format = gst_structure_get_string(st, "format");
+  gsize length = format ? strlen(format) : 0;
+
+  if (4 == length) {
+    return 1;
+  }
+
+  if (length > 6 && (g_str_has_suffix(format, "le") ||
+                     g_str_has_suffix(format, "be"))) {
+    *little_endian = g_str_has_suffix(format, "le");
+    return 2;
+  }
+
+  return 0;
+}
+
+/* Zero-copy, read-only view of the first plane of a video buffer. Packed
+ * formats get a channel axis. Formats unknown to GstVideo (e.g. Bayer) need
+ * the caps to know their sample size. */
+static py::array buffer_get_ndarray(GstBuffer *buffer, GstCaps *caps) {
+  GstVideoMeta *video_meta = gst_buffer_get_video_meta(buffer);
+  if (!video_meta) {
+    throw py::value_error("Buffer has no GstVideoMeta");
+  }
+
+  if (video_meta->n_planes > 1) {
+    throw py::value_error("Multi-planar formats are not supported");
+  }
+
+  const gsize height = video_meta->height;
+  const gsize width = video_meta->width;
+  const gsize stride = video_meta->stride[0];
+  gsize sample_size = 0;
+  gsize channels = 1;
+  bool little_endian = true;
+
+  const GstVideoFormatInfo *finfo =
+      gst_video_format_get_info(video_meta->format);
+  if (finfo && GST_VIDEO_FORMAT_UNKNOWN != video_meta->format) {
+    if (GST_VIDEO_FORMAT_INFO_HAS_PALETTE(finfo) ||
+        GST_VIDEO_FORMAT_INFO_IS_COMPLEX(finfo) ||
+        0 != GST_VIDEO_FORMAT_INFO_BITS(finfo) % 8 ||
+        0 == GST_VIDEO_FORMAT_INFO_PSTRIDE(finfo, 0)) {
+      throw py::value_error(string("Unsupported format ") +
+                            GST_VIDEO_FORMAT_INFO_NAME(finfo));
+    }
+    sample_size = GST_VIDEO_FORMAT_INFO_BITS(finfo) / 8;
+    channels = GST_VIDEO_FORMAT_INFO_PSTRIDE(finfo, 0) / sample_size;
+    little_endian = GST_VIDEO_FORMAT_INFO_IS_LE(finfo);
+  } else if (caps && !gst_caps_is_empty(caps) &&
+             gst_structure_has_name(gst_caps_get_structure(caps, 0),
+                                    "video/x-bayer")) {
+    sample_size = bayer_get_sample_size(gst_caps_get_structure(caps, 0),
+                                        &little_endian);
+  } else {
+    throw py::value_error(
+        "Format unknown to GstVideo, pass a GstSample to provide the caps");
+  }
+
+  if (1 != sample_size && 2 != sample_size) {
+    throw py::value_error("Unsupported sample size");
+  }
+
+  /* Mapping a buffer of several memories merges them into a copy */
+  auto mapping = new BufferMapping;
+  mapping->buffer = gst_buffer_ref(buffer);
+  if (!gst_buffer_map(buffer, &mapping->info, GST_MAP_READ)) {
+    gst_buffer_unref(buffer);
+    delete mapping;
+    throw py::value_error("Unable to map buffer");
+  }
+
+  if (mapping->info.size < video_meta->offset[0] + stride * height) {
+    buffer_mapping_free(mapping);
+    throw py::value_error("Buffer is smaller than its video meta");
+  }
+
+  py::capsule owner(mapping, buffer_mapping_free);
+
+  string type = 1 == sample_size ? "u1" : (little_endian ? "<u2" : ">u2");
+  vector<py::ssize_t> shape = {static_cast<py::ssize_t>(height),
+                               static_cast<py::ssize_t>(width)};
+  vector<py::ssize_t> strides = {static_cast<py::ssize_t>(stride),
+                                 static_cast<py::ssize_t>(sample_size *
+                                                          channels)};
+  if (channels > 1) {
+    shape.push_back(channels);
+    strides.push_back(sample_size);
+  }
+
+  py::array array(py::dtype(type), shape, strides,
+                  mapping->info.data + video_meta->offset[0], owner);
+  array.attr("setflags")("write"_a = false);
+
+  return array;
+}
+
+/* A column of the batch chunk extraction, either a GstPylonMeta field or a
+ * chunk */
+struct ChunkColumn {
+  string name;
+  GType type;
+  bool meta_field;
+  size_t size;
+  size_t offset;
+};
+
+static const GstPylonMeta *object_get_pylon_meta(size_t object) {
+  auto *mini_object = reinterpret_cast<GstMiniObject *>(object);
+  GstBuffer *buffer = NULL;
+
+  if (!mini_object) {
+    return NULL;
+  }
+
+  if (GST_IS_SAMPLE(mini_object)) {
+    buffer = gst_sample_get_buffer(GST_SAMPLE(mini_object));
+  } else if (GST_IS_BUFFER(mini_object)) {
+    buffer = GST_BUFFER(mini_object);
+  } else {
+    throw py::type_error("Expected a GstBuffer or GstSample");
+  }
+
+  return buffer ? gst_buffer_get_pylon_meta(buffer) : NULL;
+}
+
+static bool meta_get_field(const GstPylonMeta *meta, const string &name,
+                           guint64 *value) {
+  if ("block_id" == name) {
+    *value = meta ? meta->block_id : 0;
+  } else if ("image_number" == name) {
+    *value = meta ? meta->image_number : 0;
+  } else if ("skipped_images" == name) {
+    *value = meta ? meta->skipped_images : 0;
+  } else if ("offset_x" == name) {
+    *value = meta ? meta->offset.offset_x : 0;
+  } else if ("offset_y" == name) {
+    *value = meta ? meta->offset.offset_y : 0;
+  } else if ("timestamp" == name) {
+    *value = meta ? meta->timestamp : 0;
+  } else if ("stride" == name) {
+    *value = meta ? meta->stride : 0;
+  } else {
+    return false;
+  }
+
+  return true;
+}
+
+/* The type of a chunk has to be the same in all buffers, except for
+ * integers and floats, which are promoted to floats. Strings are sized for
+ * the longest value. */
+static ChunkColumn chunk_column_new(const vector<const GstPylonMeta *> &metas,
+                                    const string &name) {
+  ChunkColumn column = {name, G_TYPE_INVALID, false, 0, 0};
+  guint64 field = 0;
+  GType type = G_TYPE_INVALID;
+
+  if (meta_get_field(NULL, name, &field)) {
+    column.type = G_TYPE_UINT64;
+    column.meta_field = true;
+    column.size = sizeof(guint64);
+    return column;
+  }
+
+  for (auto meta : metas) {
+    if (!meta) {
+      continue;
+    }
+
+    type = gst_pylon_meta_get_chunk_type(meta, name.c_str());
+    if (G_TYPE_INVALID == type) {
+      continue;
+    }
+
+    if (G_TYPE_INVALID == column.type) {
+      column.type = type;
+    } else if (type != column.type) {
+      bool numeric = (G_TYPE_INT64 == type || G_TYPE_DOUBLE == type) &&
+                     (G_TYPE_INT64 == column.type ||
+                      G_TYPE_DOUBLE == column.type);
+      if (!numeric) {
+        throw py::type_error("Chunk " + name + " is both " +
+                             g_type_name(column.type) + " and " +
+                             g_type_name(type));
+      }
+      column.type = G_TYPE_DOUBLE;
+    }
+
+    if (G_TYPE_STRING == type) {
+      const gchar *str = gst_pylon_meta_get_chunk_string(meta, name.c_str());
+      column.size = std::max(column.size, str ? strlen(str) : 0);
+    }
+  }
+
+  switch (column.type) {
+    case G_TYPE_INT64:
+      column.size = sizeof(gint64);
+      break;
+    case G_TYPE_DOUBLE:
+      column.size = sizeof(gdouble);
+      break;
+    case G_TYPE_BOOLEAN:
+      column.size = sizeof(bool);
+      break;
+    case G_TYPE_STRING:
+      column.size = std::max(column.size, static_cast<size_t>(1));
+      break;
+    default:
+      throw py::key_error("Chunk " + name + " not found in any buffer");
+  }
+
+  return column;
+}
+
+static string chunk_column_format(const ChunkColumn &column) {
+  switch (column.type) {
+    case G_TYPE_UINT64:
+      return "u8";
+    case G_TYPE_INT64:
+      return "i8";
+    case G_TYPE_DOUBLE:
+      return "f8";
+    case G_TYPE_BOOLEAN:
+      return "?";
+    default:
+      return "S" + to_string(column.size);
+  }
+}
+
+/* Missing values are written as 0, NaN, False or an empty string */
+static void chunk_column_write(const ChunkColumn &column,
+                               const GstPylonMeta *meta, guint8 *dest) {
+  const gchar *name = column.name.c_str();
+  guint64 field = 0;
+  gint64 int_value = 0;
+  gdouble double_value = NAN;
+  gboolean boolean_value = FALSE;
+  bool flag = false;
+  const gchar *str = NULL;
+
+  switch (column.type) {
+    case G_TYPE_UINT64:
+      meta_get_field(meta, column.name, &field);
+      memcpy(dest, &field, sizeof(field));
+      break;
+    case G_TYPE_INT64:
+      if (meta) {
+        gst_pylon_meta_get_chunk_int64(meta, name, &int_value);
+      }
+      memcpy(dest, &int_value, sizeof(int_value));
+      break;
+    case G_TYPE_DOUBLE:
+      /* Integer chunks of a promoted column */
+      if (meta && !gst_pylon_meta_get_chunk_double(meta, name, &double_value) &&
+          gst_pylon_meta_get_chunk_int64(meta, name, &int_value)) {
+        double_value = static_cast<gdouble>(int_value);
+      }
+      memcpy(dest, &double_value, sizeof(double_value));
+      break;
+    case G_TYPE_BOOLEAN:
+      if (meta) {
+        gst_pylon_meta_get_chunk_boolean(meta, name, &boolean_value);
+      }
+      flag = boolean_value;
+      memcpy(dest, &flag, sizeof(flag));
+      break;
+    default:
+      memset(dest, 0, column.size);
+      str = meta ? gst_pylon_meta_get_chunk_string(meta, name) : NULL;
+      if (str) {
+        memcpy(dest, str, std::min(strlen(str), column.size));
+      }
+      break;
+  }
+}
+
+/* Extract chunks of many buffers at once into NumPy arrays, either one
+ * structured array with a record per buffer or a dict of column arrays */
+static py::object buffers_get_chunks(const vector<size_t> &objects,
+                                     const vector<string> &names,
+                                     bool columns) {
+  vector<const GstPylonMeta *> metas;
+  vector<ChunkColumn> chunk_columns;
+  size_t itemsize = 0;
+
+  metas.reserve(objects.size());
+  for (auto object : objects) {
+    metas.push_back(object_get_pylon_meta(object));
+  }
+
+  for (auto const &name : names) {
+    chunk_columns.push_back(chunk_column_new(metas, name));
+    chunk_columns.back().offset = itemsize;
+    itemsize += chunk_columns.back().size;
+  }
+
+  if (columns) {
+    py::dict dict;
+    vector<guint8 *> data;
+
+    for (auto const &column : chunk_columns) {
+      py::array array(py::dtype(chunk_column_format(column)),
+                      {static_cast<py::ssize_t>(metas.size())});
+      data.push_back(static_cast<guint8 *>(array.mutable_data()));
+      dict[py::str(column.name)] = array;
+    }
+
+    py::gil_scoped_release release;
+    for (size_t i = 0; i < metas.size(); i++) {
+      for (size_t c = 0; c < chunk_columns.size(); c++) {
+        chunk_column_write(chunk_columns[c], metas[i],
+                           data[c] + i * chunk_columns[c].size);
+      }
+    }
+
+    return std::move(dict);
+  }
+
+  py::list field_names;
+  py::list formats;
+  py::list offsets;
+  for (auto const &column : chunk_columns) {
+    field_names.append(column.name);
+    formats.append(chunk_column_format(column));
+    offsets.append(column.offset);
+  }
+
+  py::dict spec("names"_a = field_names, "formats"_a = formats,
+                "offsets"_a = offsets, "itemsize"_a = itemsize);
+  py::array array(py::dtype::from_args(spec),
+                  {static_cast<py::ssize_t>(metas.size())});
+  auto data = static_cast<guint8 *>(array.mutable_data());
+
+  {
+    py::gil_scoped_release release;
+    for (size_t i = 0; i < metas.size(); i++) {
+      for (auto const &column : chunk_columns) {
+        chunk_column_write(column, metas[i],
+                           data + i * itemsize + column.offset);
+      }
+    }
+  }
+
+  return std::move(array);
+}
+
 void bindaccessfunctions(py::module &m) {
   m.def(
       "gst_buffer_get_pylon_meta",
@@ -48,6 +422,39 @@ void bindaccessfunctions(py::module &m) {
         return gst_buffer_get_pylon_meta(buffer);
       },
       "buffer"_a, py::return_value_policy::reference);
+
+  m.def(
+      "gst_buffer_get_ndarray",
+      [](size_t object) {
+        auto *mini_object = reinterpret_cast<GstMiniObject *>(object);
+        if (mini_object && GST_IS_SAMPLE(mini_object)) {
+          GstSample *sample = GST_SAMPLE(mini_object);
+          GstBuffer *buffer = gst_sample_get_buffer(sample);
+          if (!buffer) {
+            throw py::value_error("Sample has no buffer");
+          }
+          return buffer_get_ndarray(buffer, gst_sample_get_caps(sample));
+        } else if (mini_object && GST_IS_BUFFER(mini_object)) {
+          return buffer_get_ndarray(GST_BUFFER(mini_object), NULL);
+        }
+        throw py::type_error("Expected a GstBuffer or GstSample");
+      },
+      "buffer"_a,
+      "Read-only NumPy view of the frame in a buffer or sample. Formats "
+      "unknown to GstVideo, like Bayer, need a sample for their caps. The "
+      "buffer stays mapped until the array is freed. The view is zero-copy "
+      "if the buffer has a single memory, otherwise mapping merges the "
+      "memories into a copy.");
+
+  m.def("gst_buffers_get_chunks", &buffers_get_chunks, "buffers"_a, "names"_a,
+        "columns"_a = false,
+        "Extract chunks and GstPylonMeta fields (block_id, image_number, "
+        "skipped_images, offset_x, offset_y, timestamp, stride) of a list of "
+        "buffers or samples into a structured NumPy array, or a dict of "
+        "column arrays if columns is True. Missing values are 0, NaN, False "
+        "or empty. A chunk that is an integer in some buffers and a float in "
+        "others becomes a float column, other type mismatches raise a "
+        "TypeError.");
 }
 
 }  // namespace pygstpylon
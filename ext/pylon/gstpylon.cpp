@@ -39,7 +39,12 @@
 #  include "gstpylondsnvmmbufferfactory.h"
 #endif
 
-#include "gst/pylon/gstpyloncache.h"
+#ifdef DMABUF_ENABLED
+#  include <gst/allocators/gstdmabuf.h>
+
+#  include "gstpylondmabufbufferfactory.h"
+#endif
+
 #include "gst/pylon/gstpylondebug.h"
 #include "gst/pylon/gstpylonformatmapping.h"
 #include "gst/pylon/gstpylonincludes.h"
@@ -47,11 +52,22 @@
 #include "gst/pylon/gstpylonobject.h"
 #include "gstchildinspector.h"
 #include "gstpylon.h"
+#include "gstpylonallocatorbufferfactory.h"
+#include "gstpylonarena.h"
+#include "gstpylonarenabufferfactory.h"
+#include "gstpylonbufferpool.h"
+#include "gstpylondescriptioncache.h"
 #include "gstpylondisconnecthandler.h"
 #include "gstpylonimagehandler.h"
+#include "gstpylonstats.h"
 #include "gstpylonsysmembufferfactory.h"
+#include "gstpylonthread.h"
 
+#include <algorithm>
+#include <atomic>
 #include <map>
+#include <mutex>
+#include <set>
 #include <vector>
 
 /* retry open camera limits in case of collision with other
@@ -69,12 +85,16 @@ typedef struct {
 typedef enum {
   MEM_SYSMEM,
   MEM_NVMM,
+  MEM_DMABUF,
 } GstPylonMemoryTypeEnum;
 
 /* prototypes */
 static std::string gst_pylon_query_default_set(
     const Pylon::CBaslerUniversalInstantCamera &camera);
 static void gst_pylon_apply_set(GstPylon *self, std::string &set);
+static void gst_pylon_register_image_handler(GstPylon *self, bool enable);
+static void gst_pylon_apply_grab_thread_priority(GstPylon *self);
+static guint gst_pylon_read_max_num_buffer(GstPylon *self, guint fallback);
 static std::string gst_pylon_get_camera_fullname(
     Pylon::CBaslerUniversalInstantCamera &camera);
 static std::string gst_pylon_get_sgrabber_name(
@@ -103,24 +123,53 @@ static std::vector<std::string> gst_pylon_pfnc_to_gst(
 static std::vector<std::string> gst_pylon_pfnc_list_to_gst(
     const GenApi::StringList_t &genapi_formats,
     const std::vector<PixelFormatMappingType> &pixel_format_mapping);
-static void gst_pylon_append_properties(
-    Pylon::CBaslerUniversalInstantCamera *camera,
-    const std::string &device_full_name, const std::string &device_type_str,
-    GstPylonCache &feature_cache, GenApi::INodeMap &nodemap,
-    gchar **device_properties, guint alignment);
-static void gst_pylon_append_camera_properties(
-    Pylon::CBaslerUniversalInstantCamera *camera, gchar **camera_properties,
-    guint alignment);
-static void gst_pylon_append_stream_grabber_properties(
-    Pylon::CBaslerUniversalInstantCamera *camera, gchar **sgrabber_properties,
-    guint alignment);
-typedef void (*GetStringProperties)(Pylon::CBaslerUniversalInstantCamera *,
-                                    gchar **, guint);
-static gchar *gst_pylon_get_string_properties(
-    GetStringProperties get_device_string_properties);
+static gchar *gst_pylon_describe_object(
+    Pylon::CBaslerUniversalInstantCamera &camera, GObject *device_obj,
+    const std::string &device_type_str);
+static void gst_pylon_describe_device(
+    Pylon::CBaslerUniversalInstantCamera &camera, GObject *gcamera,
+    GObject *gstream_grabber, gchar **camera_properties,
+    gchar **sgrabber_properties);
+static gboolean gst_pylon_needs_description(GstPylon *self);
+static void gst_pylon_update_descriptions(GstPylon *self);
+static void gst_pylon_open_refresh_device(gpointer data, gpointer user_data);
+static void gst_pylon_describe_refresh_device(gpointer data,
+                                              gpointer user_data);
+struct GstPylonDeviceDescription;
+static void gst_pylon_register_refresh_device(
+    GstPylonDeviceDescription &description);
+static void gst_pylon_run_refresh_pool(
+    GFunc func, std::vector<GstPylonDeviceDescription> &descriptions);
 
 static constexpr gint DEFAULT_ALIGNMENT = 35;
 
+/* Opening devices is mostly waiting on the transport, use more threads than
+ * processors on small machines */
+static constexpr guint MIN_REFRESH_THREADS = 4;
+
+/* Frames planned for in the instant camera queue when grabbing one by one
+ * and sizing the grab buffers */
+static constexpr guint ONE_BY_ONE_QUEUE_DEPTH = 2;
+
+/* Feature cache warm-up shared by the devices of one model, they share a
+ * cache file. The first device to get the lock fills it. */
+struct GstPylonRefreshModel {
+  std::mutex mutex;
+  bool cache_warm = false;
+};
+
+/* Device opened on the refresh pool and its description */
+struct GstPylonDeviceDescription {
+  Pylon::CDeviceInfo device_info;
+  GstPylonRefreshModel *model = NULL;
+  std::shared_ptr<Pylon::CBaslerUniversalInstantCamera> camera;
+  GObject *gcamera = NULL;
+  GObject *gstream_grabber = NULL;
+  std::string device_name;
+  gchar *camera_properties = NULL;
+  gchar *sgrabber_properties = NULL;
+};
+
 struct _GstPylon {
   GstElement *gstpylonsrc;
   std::shared_ptr<Pylon::CBaslerUniversalInstantCamera> camera =
@@ -128,15 +177,54 @@ struct _GstPylon {
   GObject *gcamera;
   GObject *gstream_grabber;
   GstPylonImageHandler image_handler;
+  bool image_handler_registered = false;
   GstPylonDisconnectHandler disconnect_handler;
 
   std::shared_ptr<GstPylonBufferFactory> buffer_factory;
   GstPylonMemoryTypeEnum mem_type;
+  GstBufferPool *buffer_pool = NULL;
+  /* Guards buffer_pool against stats readers on other threads */
+  std::mutex buffer_pool_mutex;
+  /* Allocator the system memory grab buffers come from, NULL for the
+   * built-in factory */
+  GstAllocator *allocator = NULL;
+  GstAllocationParams allocator_params;
+
+  /* Used to verify that steady state capture doesn't allocate, only the
+   * first frame of each pylon grab buffer is expected to. Buffer shells
+   * are counted by the pool. */
+  guint64 captured_frames = 0;
+  std::atomic<guint64> wrapped_allocations{0};
+  std::atomic<guint64> meta_allocations{0};
+  std::atomic<guint64> warmup_allocations{0};
+  bool allocations_warned = false;
+
+  /* Session statistics, readable while the streaming thread captures */
+  GstPylonStats stats;
+
+  GstPylonChunkPlan *chunk_plan = gst_pylon_chunk_plan_new();
+  /* Chunk configuration changed for the downstream chunk request, undone
+   * when the request changes */
+  std::vector<std::string> enabled_chunks;
+  bool enabled_chunk_mode = false;
 
   std::string requested_device_user_name;
   std::string requested_device_serial_number;
   gint requested_device_index;
 
+  guint grab_queue_depth;
+  GstPylonQueuePolicyEnum grab_queue_policy;
+  GstPylonGrabStrategyEnum grab_strategy;
+  guint output_queue_size;
+  GstPylonCaptureModeEnum capture_mode;
+  GstPylonMemoryPagesEnum memory_pages;
+  gboolean memory_lock;
+  gint numa_node;
+  std::string grab_thread_affinity;
+  gint grab_thread_priority;
+  gboolean use_arena;
+  guint64 arena_reservation;
+
 #ifdef NVMM_ENABLED
   GstPylonNvsurfaceLayoutEnum nvsurface_layout;
   guint gpu_id;
@@ -144,7 +232,7 @@ struct _GstPylon {
 };
 
 using GrabResultPair = std::pair<std::shared_ptr<GstPylonBufferFactory>,
-                                 Pylon::CBaslerUniversalGrabResultPtr *>;
+                                 Pylon::CBaslerUniversalGrabResultPtr>;
 
 static const std::vector<GstStPixelFormats> gst_structure_formats = {
     {"video/x-raw", pixel_format_mapping_raw},
@@ -299,9 +387,16 @@ GstPylon *gst_pylon_new(GstElement *gstpylonsrc, const gchar *device_user_name,
     self->camera->DeviceRegistersStreamingEnd.TryExecute();
 
     /* Set the camera to a valid state
-     * load the poweron user set
+     * load the poweron user set. Devices the element doesn't document yet
+     * are described with the factory default set first.
      */
-    if (self->camera->UserSetSelector.IsWritable()) {
+    gboolean describe = gst_pylon_needs_description(self);
+    gboolean factory_set =
+        describe && self->camera->UserSetSelector.CanSetValue("Default");
+    if (factory_set) {
+      self->camera->UserSetSelector.SetValue("Default");
+      self->camera->UserSetLoad.Execute();
+    } else if (self->camera->UserSetSelector.IsWritable()) {
       std::string default_set = "Auto";
       gst_pylon_apply_set(self, default_set);
     }
@@ -317,16 +412,35 @@ GstPylon *gst_pylon_new(GstElement *gstpylonsrc, const gchar *device_user_name,
         self->camera, gst_pylon_get_sgrabber_name(*self->camera),
         &sgrabber_nodemap, enable_correction);
 
+    if (describe) {
+      gst_pylon_update_descriptions(self);
+    }
+
+    /* Back to the poweron user set */
+    if (factory_set) {
+      std::string default_set = "Auto";
+      gst_pylon_apply_set(self, default_set);
+    }
+
     /* Register event handlers after device instances are requested so they do
      * not get registered if creating the device instances fails */
-    self->camera->RegisterImageEventHandler(&self->image_handler,
-                                            Pylon::RegistrationMode_Append,
-                                            Pylon::Cleanup_None);
+    gst_pylon_register_image_handler(self, true);
     self->disconnect_handler.SetData(self->gstpylonsrc, &self->image_handler);
     self->camera->RegisterConfiguration(&self->disconnect_handler,
                                         Pylon::RegistrationMode_Append,
                                         Pylon::Cleanup_None);
     self->mem_type = MEM_SYSMEM;
+    self->grab_queue_depth = PROP_GRAB_QUEUE_DEPTH_DEFAULT;
+    self->grab_queue_policy = PROP_GRAB_QUEUE_POLICY_DEFAULT;
+    self->grab_strategy = PROP_GRAB_STRATEGY_DEFAULT;
+    self->output_queue_size = PROP_OUTPUT_QUEUE_SIZE_DEFAULT;
+    self->capture_mode = PROP_CAPTURE_MODE_DEFAULT;
+    self->memory_pages = PROP_MEMORY_PAGES_DEFAULT;
+    self->memory_lock = PROP_MEMORY_LOCK_DEFAULT;
+    self->numa_node = PROP_NUMA_NODE_DEFAULT;
+    self->grab_thread_priority = PROP_GRAB_THREAD_PRIORITY_DEFAULT;
+    self->use_arena = PROP_USE_ARENA_DEFAULT;
+    self->arena_reservation = PROP_ARENA_RESERVATION_DEFAULT;
 
 #ifdef NVMM_ENABLED
     self->nvsurface_layout = PROP_NVSURFACE_LAYOUT_DEFAULT;
@@ -408,23 +522,183 @@ gboolean gst_pylon_set_pfs_config(GstPylon *self, const gchar *pfs_location,
 void gst_pylon_free(GstPylon *self) {
   g_return_if_fail(self);
 
-  self->camera->DeregisterImageEventHandler(&self->image_handler);
+  gst_object_replace(reinterpret_cast<GstObject **>(&self->buffer_pool),
+                     NULL);
+  gst_object_replace(reinterpret_cast<GstObject **>(&self->allocator), NULL);
+  gst_pylon_register_image_handler(self, false);
   self->camera->DeregisterConfiguration(&self->disconnect_handler);
   self->camera->Close();
   g_object_unref(self->gcamera);
+  gst_pylon_chunk_plan_free(self->chunk_plan);
 
   delete self;
 }
 
+static void gst_pylon_register_image_handler(GstPylon *self, bool enable) {
+  if (enable == self->image_handler_registered) {
+    return;
+  }
+
+  if (enable) {
+    self->camera->RegisterImageEventHandler(&self->image_handler,
+                                            Pylon::RegistrationMode_Append,
+                                            Pylon::Cleanup_None);
+  } else {
+    self->camera->DeregisterImageEventHandler(&self->image_handler);
+  }
+
+  self->image_handler_registered = enable;
+}
+
+/* Buffers (pool shells and wrapped results) and metas allocated by
+ * capture. Each grab buffer may allocate one of each during warm-up,
+ * anything beyond is allocated in steady state. */
+typedef struct {
+  guint64 buffers;
+  guint64 metas;
+  guint64 steady_state;
+} GstPylonAllocations;
+
+static GstPylonAllocations gst_pylon_get_allocations(GstPylon *self,
+                                                     GstBufferPool *pool) {
+  GstPylonAllocations allocations = {0, 0, 0};
+  const guint64 warmup = self->warmup_allocations.load();
+
+  allocations.buffers = self->wrapped_allocations.load();
+  if (pool) {
+    allocations.buffers += gst_pylon_buffer_pool_get_allocations(pool);
+  }
+  allocations.metas = self->meta_allocations.load();
+
+  if (allocations.buffers > warmup) {
+    allocations.steady_state += allocations.buffers - warmup;
+  }
+  if (allocations.metas > warmup) {
+    allocations.steady_state += allocations.metas - warmup;
+  }
+
+  return allocations;
+}
+
+static void gst_pylon_log_allocations(GstPylon *self) {
+  if (0 == self->captured_frames) {
+    return;
+  }
+
+  GstPylonAllocations allocations =
+      gst_pylon_get_allocations(self, self->buffer_pool);
+
+  GST_INFO("Captured %" G_GUINT64_FORMAT " frames with %" G_GUINT64_FORMAT
+           " buffer and %" G_GUINT64_FORMAT " meta allocations (%"
+           G_GUINT64_FORMAT " wrapped, %" G_GUINT64_FORMAT " in steady state)",
+           self->captured_frames, allocations.buffers, allocations.metas,
+           self->wrapped_allocations.load(), allocations.steady_state);
+}
+
+/* Warns once if capture keeps allocating after every grab buffer got its
+ * shell and meta. Without a pool every frame allocates. */
+static void gst_pylon_check_allocations(GstPylon *self) {
+  if (self->allocations_warned) {
+    return;
+  }
+
+  GstPylonAllocations allocations =
+      gst_pylon_get_allocations(self, self->buffer_pool);
+  if (allocations.steady_state > 0) {
+    GST_WARNING("Capture allocated %" G_GUINT64_FORMAT
+                " buffers and %" G_GUINT64_FORMAT " metas for %"
+                G_GUINT64_FORMAT " grab buffers%s",
+                allocations.buffers, allocations.metas,
+                self->warmup_allocations.load(),
+                self->buffer_pool ? ", steady state capture is allocating"
+                                  : ", no buffer pool is used");
+    self->allocations_warned = true;
+  }
+}
+
+static Pylon::EGrabStrategy gst_pylon_grab_strategy_to_pylon(
+    GstPylonGrabStrategyEnum grab_strategy) {
+  switch (grab_strategy) {
+    case ENUM_GRAB_ONE_BY_ONE:
+      return Pylon::GrabStrategy_OneByOne;
+    case ENUM_GRAB_LATEST_IMAGES:
+      return Pylon::GrabStrategy_LatestImages;
+    case ENUM_GRAB_UPCOMING_IMAGE:
+      return Pylon::GrabStrategy_UpcomingImage;
+    case ENUM_GRAB_LATEST_IMAGE_ONLY:
+    default:
+      return Pylon::GrabStrategy_LatestImageOnly;
+  }
+}
+
+static void gst_pylon_apply_grab_thread_priority(GstPylon *self) {
+  const bool override_priority = self->grab_thread_priority > 0;
+
+  self->camera->GrabLoopThreadPriorityOverride.SetValue(override_priority);
+  self->camera->InternalGrabEngineThreadPriorityOverride.SetValue(
+      override_priority);
+
+  if (override_priority) {
+    self->camera->GrabLoopThreadPriority.SetValue(self->grab_thread_priority);
+    self->camera->InternalGrabEngineThreadPriority.SetValue(
+        self->grab_thread_priority);
+  }
+}
+
 gboolean gst_pylon_start(GstPylon *self, GError **err) {
   gboolean ret = TRUE;
 
   g_return_val_if_fail(self, FALSE);
   g_return_val_if_fail(err && *err == NULL, FALSE);
 
+  /* Pylon only supports this strategy with a user provided grab loop */
+  if (ENUM_GRAB_UPCOMING_IMAGE == self->grab_strategy &&
+      ENUM_CAPTURE_STREAMING_THREAD != self->capture_mode) {
+    g_set_error(err, GST_LIBRARY_ERROR, GST_LIBRARY_ERROR_SETTINGS,
+                "The upcoming-image grab strategy requires "
+                "capture-mode=streaming-thread");
+    return FALSE;
+  }
+
   try {
-    self->camera->StartGrabbing(Pylon::GrabStrategy_LatestImageOnly,
-                                Pylon::GrabLoop_ProvidedByInstantCamera);
+    self->image_handler.SetQueueConfiguration(self->grab_queue_depth,
+                                              self->grab_queue_policy);
+    self->image_handler.SetGrabThreadAffinity(self->grab_thread_affinity);
+    self->image_handler.Start();
+    self->captured_frames = 0;
+    self->wrapped_allocations = 0;
+    self->meta_allocations = 0;
+    /* Each grab buffer needs a shell and a meta the first time it is
+     * used */
+    self->warmup_allocations = gst_pylon_read_max_num_buffer(self, 0);
+    self->allocations_warned = false;
+    self->stats.Reset();
+    gst_pylon_chunk_plan_reset(self->chunk_plan);
+    if (self->buffer_pool) {
+      gst_pylon_buffer_pool_reset_allocations(self->buffer_pool);
+    }
+
+    if (ENUM_GRAB_LATEST_IMAGES == self->grab_strategy) {
+      self->camera->OutputQueueSize.SetValue(self->output_queue_size);
+    }
+
+    /* Pylon applies these as real-time priorities, SCHED_FIFO on Linux */
+    gst_pylon_apply_grab_thread_priority(self);
+
+    if (ENUM_CAPTURE_STREAMING_THREAD == self->capture_mode) {
+      /* RetrieveResult would otherwise also feed the grab queue */
+      gst_pylon_register_image_handler(self, false);
+      self->camera->StartGrabbing(
+          gst_pylon_grab_strategy_to_pylon(self->grab_strategy),
+          Pylon::GrabLoop_ProvidedByUser);
+      self->image_handler.SetRetrieveWaitObject(
+          self->camera->GetGrabResultWaitObject());
+    } else {
+      gst_pylon_register_image_handler(self, true);
+      self->camera->StartGrabbing(
+          gst_pylon_grab_strategy_to_pylon(self->grab_strategy),
+          Pylon::GrabLoop_ProvidedByInstantCamera);
+    }
   } catch (const Pylon::GenericException &e) {
     g_set_error(err, GST_LIBRARY_ERROR, GST_LIBRARY_ERROR_FAILED, "%s",
                 e.GetDescription());
@@ -441,7 +715,13 @@ gboolean gst_pylon_stop(GstPylon *self, GError **err) {
   g_return_val_if_fail(err && *err == NULL, FALSE);
 
   try {
+    /* Wake up a grab thread blocked on a full queue before joining it */
+    self->image_handler.Stop();
     self->camera->StopGrabbing();
+
+    GST_INFO("Grab queue dropped %" G_GUINT64_FORMAT " frames",
+             self->image_handler.GetDroppedCount());
+    gst_pylon_log_allocations(self);
   } catch (const Pylon::GenericException &e) {
     g_set_error(err, GST_LIBRARY_ERROR, GST_LIBRARY_ERROR_FAILED, "%s",
                 e.GetDescription());
@@ -462,7 +742,12 @@ static void gst_pylon_add_result_meta(
   g_return_if_fail(self);
   g_return_if_fail(buf);
 
-  gst_buffer_add_pylon_meta(buf, grab_result_ptr);
+  /* Pooled buffers keep their meta */
+  if (!gst_buffer_get_pylon_meta(buf)) {
+    self->meta_allocations++;
+  }
+
+  gst_buffer_add_pylon_meta(buf, grab_result_ptr, self->chunk_plan);
 }
 
 static void free_ptr_grab_result(gpointer data) {
@@ -470,39 +755,43 @@ static void free_ptr_grab_result(gpointer data) {
 
   auto wrapped_data = static_cast<GrabResultPair *>(data);
 
-  Pylon::CBaslerUniversalGrabResultPtr *ptr_grab_result = wrapped_data->second;
-  delete ptr_grab_result;
-
+  wrapped_data->first->BeginWrite(wrapped_data->second->GetBuffer(),
+                                  wrapped_data->second->GetBufferContext());
   delete wrapped_data;
 }
 
-gboolean gst_pylon_capture(GstPylon *self, GstBuffer **buf,
-                           GstPylonCaptureErrorEnum capture_error,
-                           GError **err) {
-  g_return_val_if_fail(self, FALSE);
-  g_return_val_if_fail(buf, FALSE);
-  g_return_val_if_fail(err && *err == NULL, FALSE);
-
+/* Wait for the next grab result to deliver according to the capture error
+ * strategy. Returns FALSE if interrupted or, with err set, on capture error */
+static gboolean gst_pylon_wait_for_result(
+    GstPylon *self, Pylon::CBaslerUniversalGrabResultPtr &grab_result,
+    gint64 &grab_time, GstPylonCaptureErrorEnum capture_error, GError **err) {
   bool retry_grab = true;
   bool buffer_error = false;
   gint retry_frame_counter = 0;
   static const gint max_frames_to_skip = 100;
-  Pylon::CBaslerUniversalGrabResultPtr *grab_result_ptr = NULL;
+  bool got_result = false;
 
   while (retry_grab) {
-    grab_result_ptr = self->image_handler.WaitForImage();
+    if (ENUM_CAPTURE_STREAMING_THREAD == self->capture_mode) {
+      got_result = self->image_handler.RetrieveImage(*self->camera,
+                                                     grab_result, grab_time);
+    } else {
+      got_result = self->image_handler.WaitForImage(grab_result, grab_time);
+    }
 
     /* Return if user requests to interrupt the grabbing thread */
-    if (!grab_result_ptr) {
+    if (!got_result) {
       return FALSE;
     }
 
-    if ((*grab_result_ptr)->GrabSucceeded()) {
+    if (grab_result->GrabSucceeded()) {
       break;
     }
 
+    self->stats.AddFailed();
+
     std::string error_message =
-        std::string((*grab_result_ptr)->GetErrorDescription());
+        std::string(grab_result->GetErrorDescription());
     switch (capture_error) {
       case ENUM_KEEP:
         /* Deliver the buffer into pipeline even if pylon reports an error */
@@ -527,8 +816,7 @@ gboolean gst_pylon_capture(GstPylon *self, GstBuffer **buf,
           GST_ELEMENT_WARNING(self->gstpylonsrc, LIBRARY, FAILED,
                               ("Capture failed. Skipping buffer."),
                               ("%s", error_message.c_str()));
-          delete grab_result_ptr;
-          grab_result_ptr = NULL;
+          grab_result.Release();
           retry_grab = true;
           retry_frame_counter += 1;
         }
@@ -538,59 +826,113 @@ gboolean gst_pylon_capture(GstPylon *self, GstBuffer **buf,
     if (buffer_error) {
       g_set_error(err, GST_LIBRARY_ERROR, GST_LIBRARY_ERROR_FAILED, "%s",
                   error_message.c_str());
-      delete grab_result_ptr;
-      grab_result_ptr = NULL;
+      grab_result.Release();
       return FALSE;
     }
   };
 
+  return TRUE;
+}
+
+/* Wrap a grab result into a newly allocated buffer */
+static gboolean gst_pylon_wrap_result(
+    GstPylon *self, GstBuffer **buf,
+    const Pylon::CBaslerUniversalGrabResultPtr &grab_result, GError **err) {
 #ifdef NVMM_ENABLED
   if (MEM_NVMM == self->mem_type) {
-    NvBufSurface *surf = reinterpret_cast<NvBufSurface *>(
-        (*grab_result_ptr)->GetBufferContext());
+    NvBufSurface *surf =
+        reinterpret_cast<NvBufSurface *>(grab_result->GetBufferContext());
 
     size_t src_stride;
-    (*grab_result_ptr)->GetStride(src_stride);
+    grab_result->GetStride(src_stride);
 
     /* calc src width in byte from pixel type info */
-    const auto src_width_pix = (*grab_result_ptr)->GetWidth();
+    const auto src_width_pix = grab_result->GetWidth();
     const auto src_bit_per_pix =
-        Pylon::BitPerPixel((*grab_result_ptr)->GetPixelType());
+        Pylon::BitPerPixel(grab_result->GetPixelType());
 
     g_assert(0 == (src_width_pix * src_bit_per_pix) % 8);
     const size_t src_width = (src_width_pix * src_bit_per_pix) >> 3;
 
     cudaError_t cuda_err = cudaMemcpy2D(
         surf->surfaceList[0].mappedAddr.addr[0], surf->surfaceList[0].pitch,
-        (*grab_result_ptr)->GetBuffer(), src_stride, src_width,
-        (*grab_result_ptr)->GetHeight(), cudaMemcpyDefault);
+        grab_result->GetBuffer(), src_stride, src_width,
+        grab_result->GetHeight(), cudaMemcpyDefault);
     if (cuda_err != cudaSuccess) {
       g_set_error(err, GST_LIBRARY_ERROR, GST_LIBRARY_ERROR_FAILED,
                   "Error copying memory to device");
       return FALSE;
     }
 
-    auto buffer_ref = new GrabResultPair(self->buffer_factory, grab_result_ptr);
+    auto buffer_ref = new GrabResultPair(self->buffer_factory, grab_result);
     *buf = gst_buffer_new_wrapped_full(
         GST_MEMORY_FLAG_READONLY, surf, sizeof(*surf), 0, sizeof(*surf),
         buffer_ref, static_cast<GDestroyNotify>(free_ptr_grab_result));
   } else {
 #endif
-    gsize buffer_size = (*grab_result_ptr)->GetImageSize();
-    auto buffer_ref = new GrabResultPair(self->buffer_factory, grab_result_ptr);
+    gsize buffer_size = grab_result->GetImageSize();
+    self->buffer_factory->EndWrite(grab_result->GetBuffer(),
+                                   grab_result->GetBufferContext());
+    auto buffer_ref = new GrabResultPair(self->buffer_factory, grab_result);
     *buf = gst_buffer_new_wrapped_full(
-        static_cast<GstMemoryFlags>(0), (*grab_result_ptr)->GetBuffer(),
-        buffer_size, 0, buffer_size, buffer_ref,
+        static_cast<GstMemoryFlags>(0), grab_result->GetBuffer(), buffer_size,
+        0, buffer_size, buffer_ref,
         static_cast<GDestroyNotify>(free_ptr_grab_result));
 #ifdef NVMM_ENABLED
   }
 #endif
 
-  gst_pylon_add_result_meta(self, *buf, *grab_result_ptr);
+  self->wrapped_allocations++;
 
   return TRUE;
 }
 
+gboolean gst_pylon_capture(GstPylon *self, GstBuffer **buf,
+                           GstPylonCaptureErrorEnum capture_error,
+                           GError **err) {
+  GstFlowReturn flow = GST_FLOW_OK;
+  gboolean ret = TRUE;
+  Pylon::CBaslerUniversalGrabResultPtr grab_result;
+  gint64 grab_time = 0;
+
+  g_return_val_if_fail(self, FALSE);
+  g_return_val_if_fail(buf, FALSE);
+  g_return_val_if_fail(err && *err == NULL, FALSE);
+
+  if (!gst_pylon_wait_for_result(self, grab_result, grab_time, capture_error,
+                                 err)) {
+    return FALSE;
+  }
+
+  /* Without a negotiated pool fall back to wrapping every result */
+  if (!self->buffer_pool || MEM_NVMM == self->mem_type) {
+    ret = gst_pylon_wrap_result(self, buf, grab_result, err);
+  } else {
+    flow = gst_pylon_buffer_pool_acquire_result(
+        self->buffer_pool, self->buffer_factory, grab_result, buf);
+    if (GST_FLOW_OK != flow) {
+      /* A flushing pool is handled like an interrupted capture */
+      if (GST_FLOW_FLUSHING != flow) {
+        g_set_error(err, GST_LIBRARY_ERROR, GST_LIBRARY_ERROR_FAILED,
+                    "Failed to acquire buffer from pool: %s",
+                    gst_flow_get_name(flow));
+      }
+      ret = FALSE;
+    }
+  }
+
+  if (ret) {
+    gst_pylon_add_result_meta(self, *buf, grab_result);
+    self->captured_frames++;
+    gst_pylon_check_allocations(self);
+    self->stats.AddDelivered(
+        grab_result->GetNumberOfSkippedImages(),
+        (g_get_monotonic_time() - grab_time) * GST_USECOND);
+  }
+
+  return ret;
+}
+
 static std::vector<std::string> gst_pylon_gst_to_pfnc(
     const std::string &gst_format,
     const std::vector<PixelFormatMappingType> &pixel_format_mapping) {
@@ -796,6 +1138,15 @@ GstCaps *gst_pylon_query_configuration(GstPylon *self, GError **err) {
           gst_caps_features_new("memory:NVMM", NULL));
 #endif
 
+#ifdef DMABUF_ENABLED
+      /* Only offered if the buffers can really be imported by devices */
+      if (GstPylonDmaBufBufferFactory::IsSupported()) {
+        gst_caps_append_structure_full(
+            caps, gst_structure_copy(st),
+            gst_caps_features_new(GST_CAPS_FEATURE_MEMORY_DMABUF, NULL));
+      }
+#endif
+
     } catch (const Pylon::GenericException &e) {
       gst_structure_free(st);
       gst_caps_unref(caps);
@@ -809,6 +1160,28 @@ GstCaps *gst_pylon_query_configuration(GstPylon *self, GError **err) {
   return caps;
 }
 
+/* Buffers without an explicit node are placed near the grab thread */
+static gint gst_pylon_get_numa_node(GstPylon *self) {
+  if (self->numa_node >= 0 || self->grab_thread_affinity.empty()) {
+    return self->numa_node;
+  }
+
+  return gst_pylon_thread_get_affinity_node(
+      self->grab_thread_affinity.c_str());
+}
+
+/* Factory for system memory grab buffers when no allocator is used */
+static std::shared_ptr<GstPylonBufferFactory> gst_pylon_make_sysmem_factory(
+    GstPylon *self) {
+  if (self->use_arena) {
+    return std::make_shared<GstPylonArenaBufferFactory>(
+        self->arena_reservation);
+  }
+
+  return std::make_shared<GstPylonSysMemBufferFactory>(
+      self->memory_pages, self->memory_lock, gst_pylon_get_numa_node(self));
+}
+
 gboolean gst_pylon_set_configuration(GstPylon *self, const GstCaps *conf,
                                      GError **err) {
   g_return_val_if_fail(self, FALSE);
@@ -959,145 +1332,295 @@ gboolean gst_pylon_set_configuration(GstPylon *self, const GstCaps *conf,
   g_object_get(self->gstream_grabber, "MaxNumBuffer", &maxnumbuffers, nullptr);
   self->camera->MaxNumBuffer.TrySetValue(maxnumbuffers);
 
+  self->mem_type = MEM_SYSMEM;
 #ifdef NVMM_ENABLED
-  GstCapsFeatures *features = gst_caps_get_features(conf, 0);
-  if (gst_caps_features_contains(features, "memory:NVMM")) {
-    self->buffer_factory = std::make_shared<GstPylonDsNvmmBufferFactory>(
-        self->nvsurface_layout, self->gpu_id);
-
-    self->buffer_factory->SetConfig(conf);
+  if (gst_caps_features_contains(gst_caps_get_features(conf, 0),
+                                 "memory:NVMM")) {
     self->mem_type = MEM_NVMM;
-  } else {
+  }
 #endif
-    self->buffer_factory = std::make_shared<GstPylonSysMemBufferFactory>();
-    self->mem_type = MEM_SYSMEM;
-#ifdef NVMM_ENABLED
+#ifdef DMABUF_ENABLED
+  if (gst_caps_features_contains(gst_caps_get_features(conf, 0),
+                                 GST_CAPS_FEATURE_MEMORY_DMABUF)) {
+    self->mem_type = MEM_DMABUF;
   }
 #endif
 
+  switch (self->mem_type) {
+#ifdef NVMM_ENABLED
+    case MEM_NVMM:
+      self->buffer_factory = std::make_shared<GstPylonDsNvmmBufferFactory>(
+          self->nvsurface_layout, self->gpu_id);
+      self->buffer_factory->SetConfig(conf);
+      break;
+#endif
+#ifdef DMABUF_ENABLED
+    case MEM_DMABUF:
+      self->buffer_factory = std::make_shared<GstPylonDmaBufBufferFactory>();
+      break;
+#endif
+    default:
+      self->buffer_factory = gst_pylon_make_sysmem_factory(self);
+      break;
+  }
+  gst_object_replace(reinterpret_cast<GstObject **>(&self->allocator), NULL);
+
   self->camera->SetBufferFactory(self->buffer_factory.get(),
                                  Pylon::Cleanup_None);
 
   return TRUE;
 }
 
-static void gst_pylon_append_properties(
-    Pylon::CBaslerUniversalInstantCamera *camera,
-    const std::string &device_full_name, const std::string &device_type_str,
-    GstPylonCache &feature_cache, GenApi::INodeMap &nodemap,
-    gchar **device_properties, guint alignment) {
-  g_return_if_fail(camera);
-  g_return_if_fail(device_properties);
-
-  GType device_type =
-      gst_pylon_object_register(device_full_name, feature_cache, nodemap);
-  GObject *device_obj = G_OBJECT(g_object_new(device_type, NULL));
-
+static gchar *gst_pylon_describe_object(
+    Pylon::CBaslerUniversalInstantCamera &camera, GObject *device_obj,
+    const std::string &device_type_str) {
   gchar *device_name = g_strdup_printf(
-      "%*s %s:\n", alignment, camera->GetDeviceInfo().GetFriendlyName().c_str(),
+      "%*s %s:\n", DEFAULT_ALIGNMENT,
+      camera.GetDeviceInfo().GetFriendlyName().c_str(),
       device_type_str.c_str());
 
   gchar *properties = gst_child_inspector_properties_to_string(
-      device_obj, alignment, device_name);
-
-  if (NULL == *device_properties) {
-    *device_properties = g_strdup(properties);
-  } else {
-    *device_properties =
-        g_strconcat(*device_properties, "\n", properties, NULL);
-  }
+      device_obj, DEFAULT_ALIGNMENT, device_name);
 
   g_free(device_name);
-  g_free(properties);
 
-  g_object_unref(device_obj);
+  return properties;
+}
+
+static void gst_pylon_describe_device(
+    Pylon::CBaslerUniversalInstantCamera &camera, GObject *gcamera,
+    GObject *gstream_grabber, gchar **camera_properties,
+    gchar **sgrabber_properties) {
+  *camera_properties = gst_pylon_describe_object(camera, gcamera, "Camera");
+  *sgrabber_properties =
+      gst_pylon_describe_object(camera, gstream_grabber, "Stream Grabber");
+}
+
+static gboolean gst_pylon_needs_description(GstPylon *self) {
+  GstPylonDescriptionCache descriptions;
+
+  descriptions.Load();
+
+  return !descriptions.HasDevice(gst_pylon_get_camera_fullname(*self->camera));
+}
+
+/* Documents the device for the element class the first time it is opened,
+ * so that the class never has to open devices itself. The documented
+ * defaults are the values of the loaded set, the factory default set on
+ * cameras that have one. */
+static void gst_pylon_update_descriptions(GstPylon *self) {
+  GstPylonDescriptionCache descriptions;
+  gchar *camera_properties = NULL;
+  gchar *sgrabber_properties = NULL;
+  GError *err = NULL;
+
+  gst_pylon_describe_device(*self->camera, self->gcamera,
+                            self->gstream_grabber, &camera_properties,
+                            &sgrabber_properties);
+
+  if (!descriptions.AddDevice(gst_pylon_get_camera_fullname(*self->camera),
+                              camera_properties, sgrabber_properties, &err)) {
+    GST_WARNING_OBJECT(self->gstpylonsrc,
+                       "Failed to save device descriptions: %s",
+                       err->message);
+    g_error_free(err);
+  }
+
+  g_free(camera_properties);
+  g_free(sgrabber_properties);
 }
 
-static void gst_pylon_append_camera_properties(
-    Pylon::CBaslerUniversalInstantCamera *camera, gchar **camera_properties,
-    guint alignment) {
-  g_return_if_fail(camera);
-  g_return_if_fail(camera_properties);
+/* Runs on the refresh pool for each device, opening it and loading the
+ * factory default set. Devices of the same model share a feature cache, the
+ * first one fills it while the others wait. No types may be created here,
+ * class initialization takes a global lock. */
+static void gst_pylon_open_refresh_device(gpointer data, gpointer user_data) {
+  GstPylonDeviceDescription *description =
+      static_cast<GstPylonDeviceDescription *>(data);
+
+  try {
+    Pylon::CTlFactory &factory = Pylon::CTlFactory::GetInstance();
+    auto camera = std::make_shared<Pylon::CBaslerUniversalInstantCamera>(
+        factory.CreateDevice(description->device_info), Pylon::Cleanup_Delete);
+    camera->Open();
+
+    /* Set the camera to a valid state
+     * close left open transactions on the device
+     */
+    camera->DeviceFeaturePersistenceEnd.TryExecute();
+    camera->DeviceRegistersStreamingEnd.TryExecute();
 
-  GenApi::INodeMap &nodemap = camera->GetNodeMap();
-  std::string camera_name = gst_pylon_get_camera_fullname(*camera);
-  std::string device_type = "Camera";
-  std::string cache_filename =
-      std::string(camera->DeviceModelName.GetValue() + "_" +
-                  camera->DeviceFirmwareVersion.GetValue() + "_" + VERSION);
+    /* Set the camera to a valid state
+     * load the factory default set
+     */
+    if (camera->UserSetSelector.IsWritable()) {
+      camera->UserSetSelector.SetValue("Default");
+      camera->UserSetLoad.Execute();
+    }
 
-  GstPylonCache feature_cache(cache_filename);
+    std::lock_guard<std::mutex> lock(description->model->mutex);
+    if (!description->model->cache_warm) {
+      gst_pylon_object_warm_cache(*camera);
+      description->model->cache_warm = true;
+    }
 
-  gst_pylon_append_properties(camera, camera_name, device_type, feature_cache,
-                              nodemap, camera_properties, alignment);
+    description->camera = camera;
+  } catch (const Pylon::GenericException &e) {
+    GST_INFO("Failed to open %s: %s",
+             description->device_info.GetFullName().c_str(),
+             e.GetDescription());
+  }
 }
 
-static void gst_pylon_append_stream_grabber_properties(
-    Pylon::CBaslerUniversalInstantCamera *camera, gchar **sgrabber_properties,
-    guint alignment) {
-  g_return_if_fail(camera);
-  g_return_if_fail(sgrabber_properties);
+/* Registers the device types on the calling thread, the limits come from
+ * the warm cache */
+static void gst_pylon_register_refresh_device(
+    GstPylonDeviceDescription &description) {
+  auto &camera = description.camera;
 
-  GenApi::INodeMap &nodemap = camera->GetStreamGrabberNodeMap();
-  std::string sgrabber_name = gst_pylon_get_sgrabber_name(*camera);
-  std::string device_type = "Stream Grabber";
-  std::string cache_filename =
-      std::string(camera->GetDeviceInfo().GetModelName() + "_" +
-                  Pylon::GetPylonVersionString() + "_" + VERSION);
+  try {
+    GenApi::INodeMap &cam_nodemap = camera->GetNodeMap();
+    description.gcamera = gst_pylon_object_new(
+        camera, gst_pylon_get_camera_fullname(*camera), &cam_nodemap, FALSE);
+
+    GenApi::INodeMap &sgrabber_nodemap = camera->GetStreamGrabberNodeMap();
+    description.gstream_grabber = gst_pylon_object_new(
+        camera, gst_pylon_get_sgrabber_name(*camera), &sgrabber_nodemap,
+        FALSE);
+  } catch (const Pylon::GenericException &e) {
+    GST_INFO("Failed to register %s: %s",
+             description.device_info.GetFullName().c_str(),
+             e.GetDescription());
+  }
+}
 
-  GstPylonCache feature_cache(cache_filename);
+/* Runs on the refresh pool for each opened device, reading its properties
+ * and closing it */
+static void gst_pylon_describe_refresh_device(gpointer data,
+                                              gpointer user_data) {
+  GstPylonDeviceDescription *description =
+      static_cast<GstPylonDeviceDescription *>(data);
+  auto &camera = description->camera;
+
+  if (!camera) {
+    return;
+  }
+
+  try {
+    if (description->gcamera && description->gstream_grabber) {
+      description->device_name = gst_pylon_get_camera_fullname(*camera);
+      gst_pylon_describe_device(*camera, description->gcamera,
+                                description->gstream_grabber,
+                                &description->camera_properties,
+                                &description->sgrabber_properties);
+    }
+  } catch (const Pylon::GenericException &e) {
+    GST_INFO("Failed to describe %s: %s",
+             description->device_info.GetFullName().c_str(),
+             e.GetDescription());
+  }
+
+  g_clear_object(&description->gstream_grabber);
+  g_clear_object(&description->gcamera);
+
+  try {
+    camera->Close();
+  } catch (const Pylon::GenericException &e) {
+    GST_INFO("Failed to close %s: %s",
+             description->device_info.GetFullName().c_str(),
+             e.GetDescription());
+  }
 
-  gst_pylon_append_properties(camera, sgrabber_name, device_type, feature_cache,
-                              nodemap, sgrabber_properties, alignment);
+  camera.reset();
 }
 
-static gchar *gst_pylon_get_string_properties(
-    GetStringProperties get_device_string_properties) {
-  gchar *camera_properties = NULL;
+/* Runs func for every device and waits for all of them */
+static void gst_pylon_run_refresh_pool(
+    GFunc func, std::vector<GstPylonDeviceDescription> &descriptions) {
+  guint max_threads = std::min<guint>(
+      descriptions.size(),
+      std::max<guint>(g_get_num_processors(), MIN_REFRESH_THREADS));
+
+  GThreadPool *pool = g_thread_pool_new(func, NULL, max_threads, FALSE, NULL);
+
+  for (auto &description : descriptions) {
+    g_thread_pool_push(pool, &description, NULL);
+  }
+
+  g_thread_pool_free(pool, FALSE, TRUE);
+}
 
+void gst_pylon_refresh_descriptions() {
   Pylon::CTlFactory &factory = Pylon::CTlFactory::GetInstance();
   Pylon::DeviceInfoList_t device_list;
+  GstPylonDescriptionCache descriptions;
+  GError *err = NULL;
 
   factory.EnumerateDevices(device_list);
+  if (device_list.empty()) {
+    return;
+  }
 
-  for (const auto &device : device_list) {
-    try {
-      Pylon::CBaslerUniversalInstantCamera camera(factory.CreateDevice(device),
-                                                  Pylon::Cleanup_Delete);
-      camera.Open();
+  std::vector<GstPylonDeviceDescription> results(device_list.size());
+  std::map<std::string, GstPylonRefreshModel> models;
 
-      /* Set the camera to a valid state
-       * close left open transactions on the device
-       */
-      camera.DeviceFeaturePersistenceEnd.TryExecute();
-      camera.DeviceRegistersStreamingEnd.TryExecute();
+  for (gsize i = 0; i < device_list.size(); i++) {
+    results[i].device_info = device_list[i];
+    results[i].model = &models[std::string(device_list[i].GetModelName())];
+  }
 
-      /* Set the camera to a valid state
-       * load the factory default set
-       */
-      if (camera.UserSetSelector.IsWritable()) {
-        camera.UserSetSelector.SetValue("Default");
-        camera.UserSetLoad.Execute();
-      }
+  gint64 start = g_get_monotonic_time();
+  gst_pylon_run_refresh_pool(gst_pylon_open_refresh_device, results);
+  gint64 opened = g_get_monotonic_time();
 
-      get_device_string_properties(&camera, &camera_properties,
-                                   DEFAULT_ALIGNMENT);
-      camera.Close();
-    } catch (const Pylon::GenericException &) {
-      continue;
+  /* Types are created on this thread only, in enumeration order, whichever
+   * device finished first */
+  for (auto &result : results) {
+    if (result.camera) {
+      gst_pylon_register_refresh_device(result);
     }
   }
+  gint64 registered = g_get_monotonic_time();
+
+  gst_pylon_run_refresh_pool(gst_pylon_describe_refresh_device, results);
+
+  GST_INFO("Refreshed %" G_GSIZE_FORMAT " devices of %" G_GSIZE_FORMAT
+           " models: opened in %" G_GINT64_FORMAT " ms, registered in %"
+           G_GINT64_FORMAT " ms, described in %" G_GINT64_FORMAT " ms",
+           results.size(), models.size(), (opened - start) / 1000,
+           (registered - opened) / 1000,
+           (g_get_monotonic_time() - registered) / 1000);
+
+  /* Devices no longer connected are dropped */
+  for (auto &result : results) {
+    if (result.camera_properties && result.sgrabber_properties) {
+      descriptions.SetDevice(result.device_name, result.camera_properties,
+                             result.sgrabber_properties);
+    }
+    g_free(result.camera_properties);
+    g_free(result.sgrabber_properties);
+  }
 
-  return camera_properties;
+  if (!descriptions.Save(&err)) {
+    GST_WARNING("Failed to save device descriptions: %s", err->message);
+    g_error_free(err);
+  }
 }
 
 gchar *gst_pylon_camera_get_string_properties() {
-  return gst_pylon_get_string_properties(gst_pylon_append_camera_properties);
+  GstPylonDescriptionCache descriptions;
+
+  descriptions.Load();
+
+  return descriptions.GetCameraDescriptions();
 }
 
 gchar *gst_pylon_stream_grabber_get_string_properties() {
-  return gst_pylon_get_string_properties(
-      gst_pylon_append_stream_grabber_properties);
+  GstPylonDescriptionCache descriptions;
+
+  descriptions.Load();
+
+  return descriptions.GetStreamDescriptions();
 }
 
 GObject *gst_pylon_get_camera(GstPylon *self) {
@@ -1125,6 +1648,479 @@ gboolean gst_pylon_is_same_device(GstPylon *self, const gint device_index,
          self->requested_device_serial_number == serial_number;
 }
 
+void gst_pylon_set_grab_queue(GstPylon *self, const guint depth,
+                              const GstPylonQueuePolicyEnum policy) {
+  g_return_if_fail(self);
+
+  self->grab_queue_depth = depth;
+  self->grab_queue_policy = policy;
+}
+
+guint64 gst_pylon_get_dropped_frames(GstPylon *self) {
+  g_return_val_if_fail(self, 0);
+
+  return self->image_handler.GetDroppedCount();
+}
+
+GstStructure *gst_pylon_get_stats(GstPylon *self) {
+  GstStructure *st = NULL;
+
+  g_return_val_if_fail(self, NULL);
+
+  st = gst_structure_new("pylonsrc-stats", "frames-grabbed", G_TYPE_UINT64,
+                         self->image_handler.GetGrabbedCount(),
+                         "frames-dropped", G_TYPE_UINT64,
+                         self->image_handler.GetDroppedCount(), NULL);
+  self->stats.Fill(st);
+
+  /* Only counters are read, the stats may be queried with the element
+   * locked. Buffers outside the pool are being processed or held
+   * downstream. */
+  std::unique_lock<std::mutex> lock(self->buffer_pool_mutex);
+  GstBufferPool *pool = self->buffer_pool
+                            ? GST_BUFFER_POOL(gst_object_ref(self->buffer_pool))
+                            : NULL;
+  lock.unlock();
+
+  GstPylonAllocations allocations = gst_pylon_get_allocations(self, pool);
+  gst_structure_set(st, "buffer-allocations", G_TYPE_UINT64,
+                    allocations.buffers, "meta-allocations", G_TYPE_UINT64,
+                    allocations.metas, "steady-state-allocations",
+                    G_TYPE_UINT64, allocations.steady_state, NULL);
+
+  if (pool) {
+    gst_structure_set(
+        st, "buffers-held", G_TYPE_UINT,
+        static_cast<guint>(gst_pylon_buffer_pool_get_held(pool)), NULL);
+    gst_object_unref(pool);
+  }
+
+  return st;
+}
+
+void gst_pylon_set_grab_strategy(GstPylon *self,
+                                 const GstPylonGrabStrategyEnum grab_strategy,
+                                 const guint output_queue_size) {
+  g_return_if_fail(self);
+
+  self->grab_strategy = grab_strategy;
+  self->output_queue_size = output_queue_size;
+}
+
+/* Frames that may wait in the instant camera output queue before they
+ * reach the grab queue. When grabbing one by one this is only bounded by
+ * the number of grab buffers, which the caller passes in. */
+static guint gst_pylon_get_queued_frames(GstPylon *self,
+                                         const guint one_by_one_queue) {
+  guint pylon_queue = 0;
+
+  switch (self->grab_strategy) {
+    case ENUM_GRAB_ONE_BY_ONE:
+      pylon_queue = one_by_one_queue;
+      break;
+    case ENUM_GRAB_LATEST_IMAGES:
+      pylon_queue = self->output_queue_size;
+      break;
+    case ENUM_GRAB_UPCOMING_IMAGE:
+      pylon_queue = 0;
+      break;
+    case ENUM_GRAB_LATEST_IMAGE_ONLY:
+    default:
+      pylon_queue = 1;
+      break;
+  }
+
+  /* The grab queue is bypassed when results are retrieved directly */
+  if (ENUM_CAPTURE_STREAMING_THREAD == self->capture_mode) {
+    return pylon_queue;
+  }
+
+  return pylon_queue + self->grab_queue_depth;
+}
+
+/* MaxNumBuffer of the camera, or the given value if it can't be read */
+static guint gst_pylon_read_max_num_buffer(GstPylon *self, guint fallback) {
+  try {
+    return self->camera->MaxNumBuffer.GetValue();
+  } catch (const Pylon::GenericException &e) {
+    GST_WARNING("Failed to read MaxNumBuffer, using %u: %s", fallback,
+                e.GetDescription());
+    return fallback;
+  }
+}
+
+guint gst_pylon_get_max_queued_frames(GstPylon *self) {
+  g_return_val_if_fail(self, 0);
+
+  return gst_pylon_get_queued_frames(
+      self, gst_pylon_read_max_num_buffer(self, ONE_BY_ONE_QUEUE_DEPTH));
+}
+
+guint gst_pylon_get_queue_depth(GstPylon *self) {
+  g_return_val_if_fail(self, 0);
+
+  return gst_pylon_get_queued_frames(self, ONE_BY_ONE_QUEUE_DEPTH);
+}
+
+void gst_pylon_set_capture_mode(GstPylon *self,
+                                const GstPylonCaptureModeEnum capture_mode) {
+  g_return_if_fail(self);
+
+  self->capture_mode = capture_mode;
+}
+
+static gboolean gst_pylon_allocation_params_equal(
+    const GstAllocationParams *a, const GstAllocationParams *b) {
+  return a->flags == b->flags && a->align == b->align &&
+         a->prefix == b->prefix && a->padding == b->padding;
+}
+
+gboolean gst_pylon_set_buffer_pool(GstPylon *self, GstBufferPool *pool,
+                                   GError **err) {
+  GstStructure *config = NULL;
+  GstAllocator *allocator = NULL;
+  GstAllocationParams params;
+
+  g_return_val_if_fail(self, FALSE);
+  g_return_val_if_fail(err && *err == NULL, FALSE);
+
+  std::unique_lock<std::mutex> lock(self->buffer_pool_mutex);
+  gst_object_replace(reinterpret_cast<GstObject **>(&self->buffer_pool),
+                     GST_OBJECT_CAST(pool));
+  lock.unlock();
+
+  /* Only system memory grab buffers can be replaced, NVMM and DMABuf need
+   * their own buffers */
+  if (!pool || MEM_SYSMEM != self->mem_type) {
+    return TRUE;
+  }
+
+  gst_allocation_params_init(&params);
+  config = gst_buffer_pool_get_config(pool);
+  gst_buffer_pool_config_get_allocator(config, &allocator, &params);
+
+  if (allocator == self->allocator &&
+      (!allocator ||
+       gst_pylon_allocation_params_equal(&params, &self->allocator_params))) {
+    gst_structure_free(config);
+    return TRUE;
+  }
+
+  try {
+    if (allocator) {
+      GST_INFO("Grabbing into memory from allocator %s",
+               GST_OBJECT_NAME(allocator));
+      self->buffer_factory =
+          std::make_shared<GstPylonAllocatorBufferFactory>(allocator, &params);
+    } else {
+      GST_INFO("Grabbing into system memory");
+      self->buffer_factory = gst_pylon_make_sysmem_factory(self);
+    }
+    self->camera->SetBufferFactory(self->buffer_factory.get(),
+                                   Pylon::Cleanup_None);
+  } catch (const Pylon::GenericException &e) {
+    gst_structure_free(config);
+    g_set_error(err, GST_LIBRARY_ERROR, GST_LIBRARY_ERROR_FAILED, "%s",
+                e.GetDescription());
+    return FALSE;
+  }
+
+  gst_object_replace(reinterpret_cast<GstObject **>(&self->allocator),
+                     GST_OBJECT_CAST(allocator));
+  self->allocator_params = params;
+  gst_structure_free(config);
+
+  return TRUE;
+}
+
+gboolean gst_pylon_buffer_pool_matches(GstBufferPool *pool, GstCaps *caps,
+                                       const guint size,
+                                       const guint num_buffers,
+                                       GstAllocator *allocator,
+                                       const GstAllocationParams *params) {
+  GstStructure *config = NULL;
+  GstCaps *pool_caps = NULL;
+  GstAllocator *pool_allocator = NULL;
+  GstAllocationParams pool_params;
+  guint pool_size = 0;
+  guint min_buffers = 0;
+  guint max_buffers = 0;
+  gboolean ret = FALSE;
+
+  g_return_val_if_fail(pool, FALSE);
+  g_return_val_if_fail(params, FALSE);
+
+  gst_allocation_params_init(&pool_params);
+  config = gst_buffer_pool_get_config(pool);
+  ret = gst_buffer_pool_config_get_params(config, &pool_caps, &pool_size,
+                                          &min_buffers, &max_buffers) &&
+        gst_buffer_pool_config_get_allocator(config, &pool_allocator,
+                                             &pool_params) &&
+        pool_caps && gst_caps_is_equal(caps, pool_caps) &&
+        size == pool_size && num_buffers == max_buffers &&
+        allocator == pool_allocator &&
+        gst_pylon_allocation_params_equal(params, &pool_params);
+  gst_structure_free(config);
+
+  return ret;
+}
+
+GstBufferPool *gst_pylon_get_buffer_pool(GstPylon *self) {
+  g_return_val_if_fail(self, NULL);
+
+  return self->buffer_pool
+             ? GST_BUFFER_POOL(gst_object_ref(self->buffer_pool))
+             : NULL;
+}
+
+gboolean gst_pylon_is_grabbing(GstPylon *self) {
+  g_return_val_if_fail(self, FALSE);
+
+  return self->camera->IsGrabbing();
+}
+
+guint gst_pylon_get_max_num_buffer(GstPylon *self) {
+  g_return_val_if_fail(self, 0);
+
+  return gst_pylon_read_max_num_buffer(self, 0);
+}
+
+gboolean gst_pylon_set_max_num_buffer(GstPylon *self, const guint num_buffers,
+                                      GError **err) {
+  g_return_val_if_fail(self, FALSE);
+  g_return_val_if_fail(err && *err == NULL, FALSE);
+
+  try {
+    self->camera->MaxNumBuffer.SetValue(num_buffers);
+  } catch (const Pylon::GenericException &e) {
+    g_set_error(err, GST_LIBRARY_ERROR, GST_LIBRARY_ERROR_FAILED, "%s",
+                e.GetDescription());
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
+/* Map a chunk field name such as ChunkCounterValue-Counter1 to its
+ * ChunkSelector entry CounterValue */
+static std::string gst_pylon_chunk_to_selector_entry(const std::string &chunk) {
+  static const std::string prefix = "Chunk";
+  std::string entry = chunk.substr(0, chunk.find('-'));
+
+  if (0 == entry.compare(0, prefix.size(), prefix)) {
+    entry = entry.substr(prefix.size());
+  }
+
+  return entry;
+}
+
+/* Put back the chunk configuration changed for the previous request */
+static void gst_pylon_restore_chunks(GstPylon *self,
+                                     GenApi::INodeMap &nodemap) {
+  Pylon::CBooleanParameter mode(nodemap, "ChunkModeActive");
+  Pylon::CEnumParameter selector(nodemap, "ChunkSelector");
+  Pylon::CBooleanParameter enable(nodemap, "ChunkEnable");
+
+  for (auto const &entry : self->enabled_chunks) {
+    selector.SetValue(entry.c_str());
+    enable.SetValue(false);
+    GST_DEBUG("Chunk %s disabled again", entry.c_str());
+  }
+  self->enabled_chunks.clear();
+
+  if (self->enabled_chunk_mode) {
+    mode.SetValue(false);
+    self->enabled_chunk_mode = false;
+  }
+}
+
+gboolean gst_pylon_set_chunk_selection(GstPylon *self,
+                                       const gchar *const *chunks,
+                                       GError **err) {
+  g_return_val_if_fail(self, FALSE);
+  g_return_val_if_fail(err && *err == NULL, FALSE);
+
+  gst_pylon_chunk_plan_set_selection(self->chunk_plan, chunks);
+
+  try {
+    GenApi::INodeMap &nodemap = self->camera->GetNodeMap();
+    Pylon::CBooleanParameter mode(nodemap, "ChunkModeActive");
+    Pylon::CEnumParameter selector(nodemap, "ChunkSelector");
+    Pylon::CBooleanParameter enable(nodemap, "ChunkEnable");
+
+    gst_pylon_restore_chunks(self, nodemap);
+
+    /* Without a request the camera configuration is left to the user */
+    if (!chunks) {
+      return TRUE;
+    }
+
+    if (!mode.IsWritable() || !selector.IsWritable()) {
+      g_set_error(err, GST_LIBRARY_ERROR, GST_LIBRARY_ERROR_FAILED,
+                  "Chunks were requested, but the camera doesn't support "
+                  "them");
+      return FALSE;
+    }
+
+    GenApi::StringList_t symbolics;
+    std::set<std::string> entries;
+    selector.GetSymbolics(symbolics);
+    for (auto const &symbolic : symbolics) {
+      entries.insert(symbolic.c_str());
+    }
+
+    if (!mode.GetValue()) {
+      mode.SetValue(true);
+      self->enabled_chunk_mode = true;
+    }
+
+    /* Only switch on what was asked for, chunks enabled by the user stay
+     * enabled and are just not decoded */
+    std::set<std::string> requested;
+    for (const gchar *const *chunk = chunks; *chunk; chunk++) {
+      requested.insert(gst_pylon_chunk_to_selector_entry(*chunk));
+    }
+
+    for (auto const &entry : requested) {
+      if (entries.find(entry) == entries.end() ||
+          !selector.CanSetValue(entry.c_str())) {
+        GST_WARNING("Requested chunk %s is not supported by the camera",
+                    entry.c_str());
+        continue;
+      }
+
+      selector.SetValue(entry.c_str());
+      if (enable.IsWritable() && !enable.GetValue()) {
+        enable.SetValue(true);
+        self->enabled_chunks.push_back(entry);
+        GST_DEBUG("Chunk %s enabled", entry.c_str());
+      }
+    }
+  } catch (const Pylon::GenericException &e) {
+    g_set_error(err, GST_LIBRARY_ERROR, GST_LIBRARY_ERROR_FAILED, "%s",
+                e.GetDescription());
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
+gboolean gst_pylon_latch_timestamp(GstPylon *self, guint64 *ticks,
+                                   GError **err) {
+  g_return_val_if_fail(self, FALSE);
+  g_return_val_if_fail(ticks, FALSE);
+  g_return_val_if_fail(err && *err == NULL, FALSE);
+
+  try {
+    if (self->camera->TimestampLatch.IsWritable()) {
+      self->camera->TimestampLatch.Execute();
+      *ticks = self->camera->TimestampLatchValue.GetValue();
+    } else if (self->camera->GevTimestampControlLatch.IsWritable()) {
+      self->camera->GevTimestampControlLatch.Execute();
+      *ticks = self->camera->GevTimestampValue.GetValue();
+    } else {
+      g_set_error(err, GST_LIBRARY_ERROR, GST_LIBRARY_ERROR_FAILED,
+                  "Camera doesn't support latching its timestamp");
+      return FALSE;
+    }
+  } catch (const Pylon::GenericException &e) {
+    g_set_error(err, GST_LIBRARY_ERROR, GST_LIBRARY_ERROR_FAILED, "%s",
+                e.GetDescription());
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
+/* Time from the start of the exposure until the frame is received, based on
+ * the current configuration. Features a camera doesn't have count as 0. */
+gboolean gst_pylon_get_capture_latency(GstPylon *self, GstClockTime *latency,
+                                       GError **err) {
+  gdouble exposure_us = 0;
+  gdouble readout_us = 0;
+  gint64 payload_size = 0;
+  gint64 throughput = 0;
+  GstClockTime transfer = 0;
+
+  g_return_val_if_fail(self, FALSE);
+  g_return_val_if_fail(latency, FALSE);
+  g_return_val_if_fail(err && *err == NULL, FALSE);
+
+  try {
+    if (self->camera->ExposureTime.IsReadable()) {
+      exposure_us = self->camera->ExposureTime.GetValue();
+    } else if (self->camera->ExposureTimeAbs.IsReadable()) {
+      exposure_us = self->camera->ExposureTimeAbs.GetValue();
+    }
+
+    if (self->camera->SensorReadoutTime.IsReadable()) {
+      readout_us = self->camera->SensorReadoutTime.GetValue();
+    }
+
+    if (self->camera->PayloadSize.IsReadable()) {
+      payload_size = self->camera->PayloadSize.GetValue();
+    }
+
+    /* Bytes per second, GigE cameras only report the link speed in Mbps */
+    if (self->camera->DeviceLinkCurrentThroughput.IsReadable()) {
+      throughput = self->camera->DeviceLinkCurrentThroughput.GetValue();
+    } else if (self->camera->GevLinkSpeed.IsReadable()) {
+      throughput = self->camera->GevLinkSpeed.GetValue() * 1000000 / 8;
+    }
+  } catch (const Pylon::GenericException &e) {
+    g_set_error(err, GST_LIBRARY_ERROR, GST_LIBRARY_ERROR_FAILED, "%s",
+                e.GetDescription());
+    return FALSE;
+  }
+
+  if (throughput > 0) {
+    transfer = gst_util_uint64_scale(payload_size, GST_SECOND, throughput);
+  }
+
+  *latency = (exposure_us + readout_us) * GST_USECOND + transfer;
+
+  GST_DEBUG("Capture latency %" GST_TIME_FORMAT ": exposure %f us, readout %f "
+            "us, %" G_GINT64_FORMAT " bytes at %" G_GINT64_FORMAT " bytes/s",
+            GST_TIME_ARGS(*latency), exposure_us, readout_us, payload_size,
+            throughput);
+
+  return TRUE;
+}
+
+void gst_pylon_set_memory_config(GstPylon *self,
+                                 const GstPylonMemoryPagesEnum pages,
+                                 const gboolean lock, const gint numa_node) {
+  g_return_if_fail(self);
+
+  self->memory_pages = pages;
+  self->memory_lock = lock;
+  self->numa_node = numa_node;
+}
+
+void gst_pylon_set_grab_thread_config(GstPylon *self, const gchar *affinity,
+                                      const gint priority) {
+  g_return_if_fail(self);
+
+  self->grab_thread_affinity = affinity ? affinity : "";
+  self->grab_thread_priority = priority;
+}
+
+void gst_pylon_set_arena_config(GstPylon *self, const gboolean use_arena,
+                                const guint64 reservation) {
+  g_return_if_fail(self);
+
+  self->use_arena = use_arena;
+  self->arena_reservation = reservation;
+}
+
+void gst_pylon_set_arena_budget(const guint64 budget) {
+  GstPylonArena::GetInstance().SetBudget(budget);
+}
+
+guint64 gst_pylon_get_arena_budget() {
+  return GstPylonArena::GetInstance().GetBudget();
+}
+
 #ifdef NVMM_ENABLED
 void gst_pylon_set_nvsurface_layout(
     GstPylon *self, const GstPylonNvsurfaceLayoutEnum nvsurface_layout) {
@@ -44,6 +44,64 @@ typedef enum {
   ENUM_ABORT = 2,
 } GstPylonCaptureErrorEnum;
 
+typedef enum {
+  ENUM_QUEUE_DROP_OLDEST = 0,
+  ENUM_QUEUE_DROP_NEWEST = 1,
+  ENUM_QUEUE_BLOCK = 2,
+} GstPylonQueuePolicyEnum;
+
+#define PROP_GRAB_QUEUE_DEPTH_DEFAULT 1
+#define PROP_GRAB_QUEUE_POLICY_DEFAULT ENUM_QUEUE_DROP_NEWEST
+
+typedef enum {
+  ENUM_GRAB_ONE_BY_ONE = 0,
+  ENUM_GRAB_LATEST_IMAGE_ONLY = 1,
+  ENUM_GRAB_LATEST_IMAGES = 2,
+  ENUM_GRAB_UPCOMING_IMAGE = 3,
+} GstPylonGrabStrategyEnum;
+
+#define PROP_GRAB_STRATEGY_DEFAULT ENUM_GRAB_LATEST_IMAGE_ONLY
+#define PROP_OUTPUT_QUEUE_SIZE_DEFAULT 1
+
+typedef enum {
+  ENUM_CAPTURE_GRAB_THREAD = 0,
+  ENUM_CAPTURE_STREAMING_THREAD = 1,
+} GstPylonCaptureModeEnum;
+
+#define PROP_CAPTURE_MODE_DEFAULT ENUM_CAPTURE_GRAB_THREAD
+
+typedef enum {
+  ENUM_PAGES_NORMAL = 0,
+  ENUM_PAGES_TRANSPARENT_HUGE = 1,
+  ENUM_PAGES_HUGE = 2,
+} GstPylonMemoryPagesEnum;
+
+#define PROP_MEMORY_PAGES_DEFAULT ENUM_PAGES_NORMAL
+#define PROP_MEMORY_LOCK_DEFAULT FALSE
+#define PROP_NUMA_NODE_DEFAULT -1
+
+#define PROP_GRAB_THREAD_PRIORITY_DEFAULT 0
+
+#define PROP_USE_ARENA_DEFAULT FALSE
+#define PROP_ARENA_RESERVATION_DEFAULT 0
+#define PROP_ARENA_BUDGET_DEFAULT 0
+
+typedef enum {
+  ENUM_BUFFER_COUNT_MANUAL = 0,
+  ENUM_BUFFER_COUNT_AUTO = 1,
+} GstPylonBufferCountModeEnum;
+
+#define PROP_BUFFER_COUNT_MODE_DEFAULT ENUM_BUFFER_COUNT_MANUAL
+#define PROP_TARGET_LATENCY_DEFAULT 0
+#define PROP_BUFFER_MEMORY_LIMIT_DEFAULT 0
+
+typedef enum {
+  ENUM_TIMESTAMP_PIPELINE_CLOCK = 0,
+  ENUM_TIMESTAMP_CAMERA_CLOCK = 1,
+} GstPylonTimestampModeEnum;
+
+#define PROP_TIMESTAMP_MODE_DEFAULT ENUM_TIMESTAMP_PIPELINE_CLOCK
+
 #ifdef NVMM_ENABLED
 typedef enum {
   ENUM_BLOCK_LINEAR = 0,
@@ -74,6 +132,7 @@ gboolean gst_pylon_set_configuration(GstPylon *self, const GstCaps *conf,
                                      GError **err);
 gboolean gst_pylon_set_pfs_config(GstPylon *self, const gchar *pfs_location,
                                   GError **err);
+void gst_pylon_refresh_descriptions();
 gchar *gst_pylon_camera_get_string_properties();
 gchar *gst_pylon_stream_grabber_get_string_properties();
 
@@ -84,6 +143,51 @@ gboolean gst_pylon_is_same_device(GstPylon *self, const gint device_index,
                                   const gchar *device_user_name,
                                   const gchar *device_serial_number);
 
+void gst_pylon_set_grab_queue(GstPylon *self, const guint depth,
+                              const GstPylonQueuePolicyEnum policy);
+guint64 gst_pylon_get_dropped_frames(GstPylon *self);
+GstStructure *gst_pylon_get_stats(GstPylon *self);
+void gst_pylon_set_grab_strategy(GstPylon *self,
+                                 const GstPylonGrabStrategyEnum grab_strategy,
+                                 const guint output_queue_size);
+guint gst_pylon_get_max_queued_frames(GstPylon *self);
+/* Like gst_pylon_get_max_queued_frames(), but independent of the number of
+ * grab buffers, to size them */
+guint gst_pylon_get_queue_depth(GstPylon *self);
+void gst_pylon_set_capture_mode(GstPylon *self,
+                                const GstPylonCaptureModeEnum capture_mode);
+/* Grab into buffers of the pool, allocated by the allocator of its config,
+ * or by the built-in factory if it has none */
+gboolean gst_pylon_set_buffer_pool(GstPylon *self, GstBufferPool *pool,
+                                   GError **err);
+GstBufferPool *gst_pylon_get_buffer_pool(GstPylon *self);
+/* Whether the pool is configured like this already */
+gboolean gst_pylon_buffer_pool_matches(GstBufferPool *pool, GstCaps *caps,
+                                       const guint size,
+                                       const guint num_buffers,
+                                       GstAllocator *allocator,
+                                       const GstAllocationParams *params);
+gboolean gst_pylon_is_grabbing(GstPylon *self);
+guint gst_pylon_get_max_num_buffer(GstPylon *self);
+gboolean gst_pylon_set_max_num_buffer(GstPylon *self, const guint num_buffers,
+                                      GError **err);
+gboolean gst_pylon_set_chunk_selection(GstPylon *self,
+                                       const gchar *const *chunks,
+                                       GError **err);
+gboolean gst_pylon_latch_timestamp(GstPylon *self, guint64 *ticks,
+                                   GError **err);
+gboolean gst_pylon_get_capture_latency(GstPylon *self, GstClockTime *latency,
+                                       GError **err);
+void gst_pylon_set_memory_config(GstPylon *self,
+                                 const GstPylonMemoryPagesEnum pages,
+                                 const gboolean lock, const gint numa_node);
+void gst_pylon_set_grab_thread_config(GstPylon *self, const gchar *affinity,
+                                      const gint priority);
+void gst_pylon_set_arena_config(GstPylon *self, const gboolean use_arena,
+                                const guint64 reservation);
+void gst_pylon_set_arena_budget(const guint64 budget);
+guint64 gst_pylon_get_arena_budget();
+
 #ifdef NVMM_ENABLED
 void gst_pylon_set_nvsurface_layout(
     GstPylon *self, const GstPylonNvsurfaceLayoutEnum nvsurface_layout);
@@ -0,0 +1,102 @@
+/* Copyright (C) 2024 Basler AG
+ *
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *     1. Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *     2. Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *     3. Neither the name of the copyright holder nor the names of
+ *        its contributors may be used to endorse or promote products
+ *        derived from this software without specific prior written
+ *        permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "gst/pylon/gstpylondebug.h"
+#include "gstpylonallocatorbufferfactory.h"
+
+GstPylonAllocatorBufferFactory::GstPylonAllocatorBufferFactory(
+    GstAllocator *allocator, const GstAllocationParams *params)
+    : allocator(GST_ALLOCATOR(gst_object_ref(allocator))) {
+  if (params) {
+    this->params = *params;
+  } else {
+    gst_allocation_params_init(&this->params);
+  }
+}
+
+GstPylonAllocatorBufferFactory::~GstPylonAllocatorBufferFactory() {
+  gst_object_unref(this->allocator);
+}
+
+void GstPylonAllocatorBufferFactory::AllocateBuffer(size_t buffer_size,
+                                                    void **p_created_buffer,
+                                                    intptr_t &buffer_context) {
+  GstMemory *mem = NULL;
+  GstMapInfo *info = NULL;
+
+  *p_created_buffer = nullptr;
+
+  mem = gst_allocator_alloc(this->allocator, buffer_size, &this->params);
+  if (!mem) {
+    GST_ERROR("Allocator %s failed to allocate %" G_GSIZE_FORMAT " bytes",
+              GST_OBJECT_NAME(this->allocator), buffer_size);
+    return;
+  }
+
+  /* The mapping is kept for the lifetime of the grab buffer. Map read-write
+   * so downstream can still map the memory for reading. */
+  info = new GstMapInfo;
+  if (!gst_memory_map(mem, info, GST_MAP_READWRITE)) {
+    GST_ERROR("Unable to map memory from allocator %s",
+              GST_OBJECT_NAME(this->allocator));
+    delete info;
+    gst_memory_unref(mem);
+    return;
+  }
+
+  *p_created_buffer = info->data;
+  buffer_context = reinterpret_cast<intptr_t>(info);
+}
+
+void GstPylonAllocatorBufferFactory::FreeBuffer(void *p_created_buffer,
+                                                intptr_t buffer_context) {
+  GstMapInfo *info = reinterpret_cast<GstMapInfo *>(buffer_context);
+  GstMemory *mem = NULL;
+
+  if (!info) {
+    return;
+  }
+
+  mem = info->memory;
+  gst_memory_unmap(mem, info);
+  gst_memory_unref(mem);
+  delete info;
+}
+
+void GstPylonAllocatorBufferFactory::DestroyBufferFactory() { delete this; }
+
+GstMemory *GstPylonAllocatorBufferFactory::GetMemory(void *p_created_buffer,
+                                                     intptr_t buffer_context) {
+  GstMapInfo *info = reinterpret_cast<GstMapInfo *>(buffer_context);
+
+  return info ? info->memory : NULL;
+}
@@ -0,0 +1,198 @@
+/* Copyright (C) 2024 Basler AG
+ *
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *     1. Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *     2. Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *     3. Neither the name of the copyright holder nor the names of
+ *        its contributors may be used to endorse or promote products
+ *        derived from this software without specific prior written
+ *        permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "gst/pylon/gstpylondebug.h"
+#include "gstpylonarena.h"
+
+#if defined(__GNUC__)
+#  include <stdlib.h>
+#  include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <iterator>
+
+/* Cached slabs are only reused if they waste less than half of the
+ * requested size */
+constexpr size_t SLAB_REUSE_WASTE_DIVISOR = 2;
+
+GstPylonArena &GstPylonArena::GetInstance() {
+  static GstPylonArena arena;
+
+  return arena;
+}
+
+GstPylonArena::GstPylonArena() : budget(0), used(0), cached(0), peak(0) {
+#if defined(__GNUC__)
+  this->page_size = getpagesize();
+#else
+  this->page_size = 4096;
+#endif
+}
+
+GstPylonArena::~GstPylonArena() { this->Trim(0); }
+
+void GstPylonArena::SetBudget(guint64 budget) {
+  std::lock_guard<std::mutex> lock(this->mutex);
+
+  this->budget = budget;
+  if (this->budget) {
+    this->Trim(this->budget > this->used ? this->budget - this->used : 0);
+  }
+}
+
+guint64 GstPylonArena::GetBudget() {
+  std::lock_guard<std::mutex> lock(this->mutex);
+
+  return this->budget;
+}
+
+GstPylonArena::Client *GstPylonArena::RegisterClient(guint64 reservation) {
+  std::lock_guard<std::mutex> lock(this->mutex);
+  Client *client = new Client{reservation, 0};
+  const guint64 committed = this->used + this->GetUnusedReservations(NULL);
+
+  if (this->budget && committed + reservation > this->budget) {
+    GST_WARNING("Arena reservation of %" G_GUINT64_FORMAT
+                " bytes exceeds the remaining budget",
+                reservation);
+  }
+
+  this->clients.insert(client);
+
+  return client;
+}
+
+void GstPylonArena::UnregisterClient(Client *client) {
+  std::lock_guard<std::mutex> lock(this->mutex);
+
+  this->clients.erase(client);
+  delete client;
+
+  /* Nobody is left to reuse the cache */
+  if (this->clients.empty()) {
+    this->Trim(0);
+    this->peak = 0;
+  }
+}
+
+guint64 GstPylonArena::GetUnusedReservations(const Client *exclude) {
+  guint64 unused = 0;
+
+  for (const auto &client : this->clients) {
+    if (client != exclude && client->reservation > client->used) {
+      unused += client->reservation - client->used;
+    }
+  }
+
+  return unused;
+}
+
+/* Free cached slabs, largest first, until at most limit bytes are cached */
+void GstPylonArena::Trim(guint64 limit) {
+  while (this->cached > limit && !this->cached_slabs.empty()) {
+    auto largest = std::prev(this->cached_slabs.end());
+
+    this->cached -= largest->first;
+    free(largest->second);
+    this->cached_slabs.erase(largest);
+  }
+}
+
+void *GstPylonArena::Allocate(Client *client, size_t size,
+                              size_t &slab_size) {
+  std::lock_guard<std::mutex> lock(this->mutex);
+  const size_t aligned_size =
+      (size + this->page_size - 1) / this->page_size * this->page_size;
+  const guint64 reserved = this->GetUnusedReservations(client);
+  void *slab = NULL;
+
+  auto cached_slab = this->cached_slabs.lower_bound(aligned_size);
+  if (cached_slab != this->cached_slabs.end() &&
+      cached_slab->first - aligned_size <=
+          aligned_size / SLAB_REUSE_WASTE_DIVISOR) {
+    slab_size = cached_slab->first;
+  } else {
+    cached_slab = this->cached_slabs.end();
+    slab_size = aligned_size;
+  }
+
+  if (this->budget && this->used + slab_size + reserved > this->budget) {
+    GST_ERROR("Arena budget of %" G_GUINT64_FORMAT
+              " bytes exhausted: %" G_GUINT64_FORMAT
+              " bytes in use, %" G_GUINT64_FORMAT
+              " bytes reserved by other cameras",
+              this->budget, this->used, reserved);
+    return NULL;
+  }
+
+  if (cached_slab != this->cached_slabs.end()) {
+    slab = cached_slab->second;
+    this->cached -= slab_size;
+    this->cached_slabs.erase(cached_slab);
+  } else {
+    /* Make room for the new slab. Memory held for reuse never grows the
+     * total beyond the peak usage, nor beyond the budget */
+    guint64 limit = std::max(this->peak, this->used + slab_size);
+    if (this->budget) {
+      limit = std::min(limit, this->budget - reserved);
+    }
+    this->Trim(limit - this->used - slab_size);
+
+#if defined(__GNUC__)
+    if (posix_memalign(&slab, this->page_size, slab_size)) {
+      slab = NULL;
+    }
+#else
+    slab = malloc(slab_size);
+#endif
+    if (!slab) {
+      return NULL;
+    }
+  }
+
+  this->used += slab_size;
+  this->peak = std::max(this->peak, this->used);
+  client->used += slab_size;
+
+  return slab;
+}
+
+void GstPylonArena::Release(Client *client, void *slab, size_t slab_size) {
+  std::lock_guard<std::mutex> lock(this->mutex);
+
+  this->used -= slab_size;
+  client->used -= slab_size;
+
+  this->cached_slabs.emplace(slab_size, slab);
+  this->cached += slab_size;
+}
@@ -0,0 +1,87 @@
+/* Copyright (C) 2024 Basler AG
+ *
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *     1. Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *     2. Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *     3. Neither the name of the copyright holder nor the names of
+ *        its contributors may be used to endorse or promote products
+ *        derived from this software without specific prior written
+ *        permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef GST_PYLON_ARENA_H
+#define GST_PYLON_ARENA_H
+
+#include <gst/gst.h>
+
+#include <map>
+#include <mutex>
+#include <set>
+
+/* Process wide pool of page aligned slabs shared by all pylonsrc instances
+ * that opt in. The total memory held, in use or cached for reuse, is kept
+ * within an optional budget. Each client can reserve a minimum that other
+ * clients can't take away. Released slabs are cached and reused for
+ * allocations of a similar size, so reconfiguring a camera to a different
+ * resolution doesn't fragment the heap. */
+class GstPylonArena {
+ public:
+  struct Client {
+    guint64 reservation;
+    guint64 used;
+  };
+
+  static GstPylonArena &GetInstance();
+
+  void SetBudget(guint64 budget);
+  guint64 GetBudget();
+
+  Client *RegisterClient(guint64 reservation);
+  void UnregisterClient(Client *client);
+
+  /* Returns a slab of at least size bytes and its actual size, or NULL if
+   * the budget doesn't allow it */
+  void *Allocate(Client *client, size_t size, size_t &slab_size);
+  void Release(Client *client, void *slab, size_t slab_size);
+
+ private:
+  GstPylonArena();
+  ~GstPylonArena();
+  GstPylonArena(const GstPylonArena &) = delete;
+  GstPylonArena &operator=(const GstPylonArena &) = delete;
+
+  guint64 GetUnusedReservations(const Client *exclude);
+  void Trim(guint64 limit);
+
+  std::mutex mutex;
+  std::set<Client *> clients;
+  std::multimap<size_t, void *> cached_slabs;
+  guint64 budget;
+  guint64 used;
+  guint64 cached;
+  guint64 peak;
+  size_t page_size;
+};
+
+#endif
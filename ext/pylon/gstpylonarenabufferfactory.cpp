@@ -0,0 +1,62 @@
+/* Copyright (C) 2024 Basler AG
+ *
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *     1. Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *     2. Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *     3. Neither the name of the copyright holder nor the names of
+ *        its contributors may be used to endorse or promote products
+ *        derived from this software without specific prior written
+ *        permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "gstpylonarenabufferfactory.h"
+
+GstPylonArenaBufferFactory::GstPylonArenaBufferFactory(guint64 reservation)
+    : client(GstPylonArena::GetInstance().RegisterClient(reservation)) {}
+
+GstPylonArenaBufferFactory::~GstPylonArenaBufferFactory() {
+  GstPylonArena::GetInstance().UnregisterClient(this->client);
+}
+
+void GstPylonArenaBufferFactory::AllocateBuffer(size_t buffer_size,
+                                                void **p_created_buffer,
+                                                intptr_t &buffer_context) {
+  size_t slab_size = 0;
+
+  *p_created_buffer = GstPylonArena::GetInstance().Allocate(
+      this->client, buffer_size, slab_size);
+  buffer_context = slab_size;
+}
+
+void GstPylonArenaBufferFactory::FreeBuffer(void *p_created_buffer,
+                                            intptr_t buffer_context) {
+  if (!p_created_buffer) {
+    return;
+  }
+
+  GstPylonArena::GetInstance().Release(this->client, p_created_buffer,
+                                       buffer_context);
+}
+
+void GstPylonArenaBufferFactory::DestroyBufferFactory() { delete this; }
@@ -39,6 +39,20 @@
 class GstPylonBufferFactory : public Pylon::IBufferFactory {
  public:
   virtual void SetConfig(const GstCaps *caps) = 0;
+
+  /* Memory backing a buffer allocated by this factory, or NULL if the
+   * buffer is plain memory that has to be wrapped. Ownership stays with the
+   * factory. */
+  virtual GstMemory *GetMemory(void *p_created_buffer,
+                               intptr_t buffer_context) {
+    return NULL;
+  }
+
+  /* Bracket the time the camera owns a buffer, for memory that needs its
+   * CPU caches synchronized. BeginWrite is called before a buffer is given
+   * to pylon to grab into, EndWrite once a frame was grabbed into it. */
+  virtual void BeginWrite(void *p_created_buffer, intptr_t buffer_context) {}
+  virtual void EndWrite(void *p_created_buffer, intptr_t buffer_context) {}
 };
 
 #endif
@@ -0,0 +1,341 @@
+/* Copyright (C) 2024 Basler AG
+ *
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *     1. Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *     2. Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *     3. Neither the name of the copyright holder nor the names of
+ *        its contributors may be used to endorse or promote products
+ *        derived from this software without specific prior written
+ *        permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include "config.h"
+#endif
+
+#include "gst/pylon/gstpylondebug.h"
+#include "gst/pylon/gstpylonmetaprivate.h"
+#include "gstpylonbufferpool.h"
+
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+
+/* Private acquire flag, tells the pool that params carry a grab result */
+#define GST_PYLON_BUFFER_POOL_ACQUIRE_FLAG_RESULT \
+  (static_cast<GstBufferPoolAcquireFlags>(GST_BUFFER_POOL_ACQUIRE_FLAG_LAST))
+
+typedef struct {
+  GstBufferPoolAcquireParams parent;
+  std::shared_ptr<GstPylonBufferFactory> *factory;
+  const Pylon::CBaslerUniversalGrabResultPtr *grab_result;
+} GstPylonBufferPoolAcquireParams;
+
+/* A buffer shell and the pylon resources it holds while it is in use */
+struct GstPylonBufferShell {
+  GstBuffer *buffer;
+  void *data;
+  std::shared_ptr<GstPylonBufferFactory> factory;
+  Pylon::CBaslerUniversalGrabResultPtr grab_result;
+};
+
+struct _GstPylonBufferPool {
+  GstBufferPool parent;
+
+  /* Shells indexed by the address of the pylon grab buffer they wrap */
+  std::unordered_map<void *, GstPylonBufferShell *> *shells;
+  std::mutex *shells_mutex;
+
+  std::atomic<guint64> *allocations;
+  /* Buffers handed out and not released yet */
+  std::atomic<guint64> *held;
+};
+
+static GQuark gst_pylon_buffer_shell_quark;
+
+/* prototypes */
+static void gst_pylon_buffer_pool_finalize(GObject *object);
+static gboolean gst_pylon_buffer_pool_start(GstBufferPool *pool);
+static gboolean gst_pylon_buffer_pool_stop(GstBufferPool *pool);
+static const gchar **gst_pylon_buffer_pool_get_options(GstBufferPool *pool);
+static GstFlowReturn gst_pylon_buffer_pool_acquire_buffer(
+    GstBufferPool *pool, GstBuffer **buffer,
+    GstBufferPoolAcquireParams *params);
+static void gst_pylon_buffer_pool_release_buffer(GstBufferPool *pool,
+                                                 GstBuffer *buffer);
+static GstPylonBufferShell *gst_pylon_buffer_shell_new(
+    GstPylonBufferFactory *factory,
+    const Pylon::CBaslerUniversalGrabResultPtr &grab_result);
+static void gst_pylon_buffer_shell_free(GstPylonBufferShell *shell);
+static void gst_pylon_buffer_pool_clear(GstPylonBufferPool *self);
+
+G_DEFINE_TYPE(GstPylonBufferPool, gst_pylon_buffer_pool, GST_TYPE_BUFFER_POOL);
+
+static void gst_pylon_buffer_pool_class_init(GstPylonBufferPoolClass *klass) {
+  GObjectClass *gobject_class = G_OBJECT_CLASS(klass);
+  GstBufferPoolClass *pool_class = GST_BUFFER_POOL_CLASS(klass);
+
+  gobject_class->finalize = gst_pylon_buffer_pool_finalize;
+
+  pool_class->start = GST_DEBUG_FUNCPTR(gst_pylon_buffer_pool_start);
+  pool_class->stop = GST_DEBUG_FUNCPTR(gst_pylon_buffer_pool_stop);
+  pool_class->get_options =
+      GST_DEBUG_FUNCPTR(gst_pylon_buffer_pool_get_options);
+  pool_class->acquire_buffer =
+      GST_DEBUG_FUNCPTR(gst_pylon_buffer_pool_acquire_buffer);
+  pool_class->release_buffer =
+      GST_DEBUG_FUNCPTR(gst_pylon_buffer_pool_release_buffer);
+
+  gst_pylon_buffer_shell_quark =
+      g_quark_from_static_string("GstPylonBufferShell");
+}
+
+static void gst_pylon_buffer_pool_init(GstPylonBufferPool *self) {
+  self->shells = new std::unordered_map<void *, GstPylonBufferShell *>();
+  self->shells_mutex = new std::mutex();
+  self->allocations = new std::atomic<guint64>(0);
+  self->held = new std::atomic<guint64>(0);
+}
+
+static void gst_pylon_buffer_pool_finalize(GObject *object) {
+  GstPylonBufferPool *self = GST_PYLON_BUFFER_POOL(object);
+
+  gst_pylon_buffer_pool_clear(self);
+
+  delete self->shells;
+  delete self->shells_mutex;
+  delete self->allocations;
+  delete self->held;
+
+  G_OBJECT_CLASS(gst_pylon_buffer_pool_parent_class)->finalize(object);
+}
+
+static const gchar **gst_pylon_buffer_pool_get_options(GstBufferPool *pool) {
+  static const gchar *options[] = {GST_BUFFER_POOL_OPTION_VIDEO_META, NULL};
+
+  return options;
+}
+
+static gboolean gst_pylon_buffer_pool_start(GstBufferPool *pool) {
+  /* Shells are created on demand as pylon hands out its grab buffers, there
+   * is nothing to preallocate */
+  return TRUE;
+}
+
+static gboolean gst_pylon_buffer_pool_stop(GstBufferPool *pool) {
+  GstPylonBufferPool *self = GST_PYLON_BUFFER_POOL(pool);
+
+  /* Stop is only called once all buffers are back in the pool */
+  gst_pylon_buffer_pool_clear(self);
+
+  return TRUE;
+}
+
+static GstPylonBufferShell *gst_pylon_buffer_shell_new(
+    GstPylonBufferFactory *factory,
+    const Pylon::CBaslerUniversalGrabResultPtr &grab_result) {
+  GstPylonBufferShell *shell = new GstPylonBufferShell();
+  GstMemory *factory_mem = NULL;
+  GstMemory *mem = NULL;
+  void *data = grab_result->GetBuffer();
+  gsize size = grab_result->GetImageSize();
+
+  /* Expose the factory memory itself so downstream recognizes its own memory
+   * type, fall back to wrapping the pointer if it can't be shared */
+  factory_mem = factory->GetMemory(data, grab_result->GetBufferContext());
+  if (factory_mem) {
+    mem = gst_memory_share(factory_mem, 0, size);
+  }
+  if (!mem) {
+    mem = gst_memory_new_wrapped(static_cast<GstMemoryFlags>(0), data, size, 0,
+                                 size, NULL, NULL);
+  }
+
+  shell->data = data;
+  shell->buffer = gst_buffer_new();
+  gst_buffer_append_memory(shell->buffer, mem);
+  /* Appending memory tags the buffer, which would make the pool discard it
+   * on release */
+  GST_BUFFER_FLAG_UNSET(shell->buffer, GST_BUFFER_FLAG_TAG_MEMORY);
+
+  gst_mini_object_set_qdata(GST_MINI_OBJECT_CAST(shell->buffer),
+                            gst_pylon_buffer_shell_quark, shell, NULL);
+
+  return shell;
+}
+
+static void gst_pylon_buffer_shell_free(GstPylonBufferShell *shell) {
+  gst_buffer_unref(shell->buffer);
+  delete shell;
+}
+
+static void gst_pylon_buffer_pool_clear(GstPylonBufferPool *self) {
+  std::lock_guard<std::mutex> lock(*self->shells_mutex);
+
+  for (auto &entry : *self->shells) {
+    gst_pylon_buffer_shell_free(entry.second);
+  }
+  self->shells->clear();
+}
+
+static GstFlowReturn gst_pylon_buffer_pool_acquire_buffer(
+    GstBufferPool *pool, GstBuffer **buffer,
+    GstBufferPoolAcquireParams *params) {
+  GstPylonBufferPool *self = GST_PYLON_BUFFER_POOL(pool);
+  GstPylonBufferPoolAcquireParams *pylon_params = NULL;
+  GstPylonBufferShell *shell = NULL;
+  void *data = NULL;
+  gsize size = 0;
+
+  if (!params || !(params->flags & GST_PYLON_BUFFER_POOL_ACQUIRE_FLAG_RESULT)) {
+    GST_ERROR_OBJECT(self, "Buffers can only be acquired for a grab result");
+    return GST_FLOW_ERROR;
+  }
+
+  if (GST_BUFFER_POOL_IS_FLUSHING(pool)) {
+    return GST_FLOW_FLUSHING;
+  }
+
+  pylon_params = reinterpret_cast<GstPylonBufferPoolAcquireParams *>(params);
+  const Pylon::CBaslerUniversalGrabResultPtr &grab_result =
+      *pylon_params->grab_result;
+
+  data = grab_result->GetBuffer();
+  size = grab_result->GetImageSize();
+
+  std::unique_lock<std::mutex> lock(*self->shells_mutex);
+
+  auto it = self->shells->find(data);
+  if (it != self->shells->end()) {
+    shell = it->second;
+
+    /* A different payload size needs a new shell */
+    if (gst_buffer_get_size(shell->buffer) != size) {
+      GST_DEBUG_OBJECT(self, "Payload size changed, replacing shell for %p",
+                       data);
+      self->shells->erase(it);
+      gst_pylon_buffer_shell_free(shell);
+      shell = NULL;
+    }
+  }
+
+  if (!shell) {
+    shell = gst_pylon_buffer_shell_new(pylon_params->factory->get(),
+                                       grab_result);
+    self->shells->emplace(data, shell);
+    self->allocations->fetch_add(1, std::memory_order_relaxed);
+    GST_DEBUG_OBJECT(self, "Created shell %p for grab buffer %p",
+                     shell->buffer, data);
+  }
+
+  lock.unlock();
+
+  (*pylon_params->factory)->EndWrite(data, grab_result->GetBufferContext());
+
+  shell->factory = *pylon_params->factory;
+  shell->grab_result = grab_result;
+  self->held->fetch_add(1, std::memory_order_relaxed);
+
+  *buffer = shell->buffer;
+
+  return GST_FLOW_OK;
+}
+
+static void gst_pylon_buffer_pool_release_buffer(GstBufferPool *pool,
+                                                 GstBuffer *buffer) {
+  GstPylonBufferPool *self = GST_PYLON_BUFFER_POOL(pool);
+  GstPylonBufferShell *shell =
+      static_cast<GstPylonBufferShell *>(gst_mini_object_get_qdata(
+          GST_MINI_OBJECT_CAST(buffer), gst_pylon_buffer_shell_quark));
+
+  g_return_if_fail(shell);
+
+  /* Take the pylon resources out of the shell first. Once the grab result
+   * is released pylon may requeue the grab buffer, and the grab thread may
+   * hand this shell out again. */
+  gst_buffer_release_pylon_meta(buffer);
+  Pylon::CBaslerUniversalGrabResultPtr grab_result = shell->grab_result;
+  std::shared_ptr<GstPylonBufferFactory> factory = std::move(shell->factory);
+  shell->grab_result.Release();
+  self->held->fetch_sub(1, std::memory_order_relaxed);
+
+  /* Downstream replaced the memory, the shell can't be reused */
+  if (GST_BUFFER_FLAG_IS_SET(buffer, GST_BUFFER_FLAG_TAG_MEMORY)) {
+    GST_DEBUG_OBJECT(self, "Discarding shell %p with modified memory", buffer);
+
+    std::lock_guard<std::mutex> lock(*self->shells_mutex);
+    auto it = self->shells->find(shell->data);
+    if (it != self->shells->end() && it->second == shell) {
+      self->shells->erase(it);
+    }
+    gst_pylon_buffer_shell_free(shell);
+  }
+
+  /* Hand the grab buffer back to pylon, the factory goes last since it owns
+   * the memory */
+  factory->BeginWrite(grab_result->GetBuffer(),
+                      grab_result->GetBufferContext());
+  grab_result.Release();
+  factory.reset();
+}
+
+GstBufferPool *gst_pylon_buffer_pool_new(void) {
+  return GST_BUFFER_POOL_CAST(
+      g_object_new(GST_TYPE_PYLON_BUFFER_POOL, NULL));
+}
+
+guint64 gst_pylon_buffer_pool_get_allocations(GstBufferPool *pool) {
+  g_return_val_if_fail(GST_IS_PYLON_BUFFER_POOL(pool), 0);
+
+  return GST_PYLON_BUFFER_POOL(pool)->allocations->load();
+}
+
+void gst_pylon_buffer_pool_reset_allocations(GstBufferPool *pool) {
+  g_return_if_fail(GST_IS_PYLON_BUFFER_POOL(pool));
+
+  GST_PYLON_BUFFER_POOL(pool)->allocations->store(0);
+}
+
+guint64 gst_pylon_buffer_pool_get_held(GstBufferPool *pool) {
+  g_return_val_if_fail(GST_IS_PYLON_BUFFER_POOL(pool), 0);
+
+  return GST_PYLON_BUFFER_POOL(pool)->held->load(std::memory_order_relaxed);
+}
+
+GstFlowReturn gst_pylon_buffer_pool_acquire_result(
+    GstBufferPool *pool, std::shared_ptr<GstPylonBufferFactory> &factory,
+    const Pylon::CBaslerUniversalGrabResultPtr &grab_result,
+    GstBuffer **buffer) {
+  GstPylonBufferPoolAcquireParams params = {};
+
+  g_return_val_if_fail(GST_IS_PYLON_BUFFER_POOL(pool), GST_FLOW_ERROR);
+  g_return_val_if_fail(buffer, GST_FLOW_ERROR);
+
+  params.parent.flags = GST_PYLON_BUFFER_POOL_ACQUIRE_FLAG_RESULT;
+  params.factory = &factory;
+  params.grab_result = &grab_result;
+
+  return gst_buffer_pool_acquire_buffer(
+      pool, buffer, reinterpret_cast<GstBufferPoolAcquireParams *>(&params));
+}
@@ -0,0 +1,70 @@
+/* Copyright (C) 2024 Basler AG
+ *
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *     1. Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *     2. Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *     3. Neither the name of the copyright holder nor the names of
+ *        its contributors may be used to endorse or promote products
+ *        derived from this software without specific prior written
+ *        permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _GST_PYLON_BUFFER_POOL_H_
+#define _GST_PYLON_BUFFER_POOL_H_
+
+#include "gstpylonbufferfactory.h"
+
+#include <gst/gst.h>
+#include <gst/pylon/gstpylonincludes.h>
+
+#include <memory>
+
+G_BEGIN_DECLS
+
+#define GST_TYPE_PYLON_BUFFER_POOL gst_pylon_buffer_pool_get_type()
+G_DECLARE_FINAL_TYPE(GstPylonBufferPool, gst_pylon_buffer_pool, GST,
+                     PYLON_BUFFER_POOL, GstBufferPool)
+
+G_END_DECLS
+
+/* Pool of buffer shells, one per pylon grab buffer. A shell wraps the pylon
+ * memory and keeps the grab result alive until the buffer returns to the
+ * pool, which hands the grab buffer back to pylon. Buffers are only
+ * created when a grab result is acquired, never by the pool itself. */
+GstBufferPool *gst_pylon_buffer_pool_new(void);
+
+GstFlowReturn gst_pylon_buffer_pool_acquire_result(
+    GstBufferPool *pool, std::shared_ptr<GstPylonBufferFactory> &factory,
+    const Pylon::CBaslerUniversalGrabResultPtr &grab_result,
+    GstBuffer **buffer);
+
+/* Number of buffer shells allocated since the last reset */
+guint64 gst_pylon_buffer_pool_get_allocations(GstBufferPool *pool);
+void gst_pylon_buffer_pool_reset_allocations(GstBufferPool *pool);
+
+/* Number of buffers being processed or held downstream, safe to call from
+ * any thread */
+guint64 gst_pylon_buffer_pool_get_held(GstBufferPool *pool);
+
+#endif
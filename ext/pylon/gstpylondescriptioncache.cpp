@@ -0,0 +1,236 @@
+/* Copyright (C) 2024 Basler AG
+ *
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *     1. Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *     2. Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *     3. Neither the name of the copyright holder nor the names of
+ *        its contributors may be used to endorse or promote products
+ *        derived from this software without specific prior written
+ *        permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include "config.h"
+#endif
+
+#include "gst/pylon/gstpylondebug.h"
+#include "gstpylondescriptioncache.h"
+
+#include <errno.h>
+#include <glib/gstdio.h>
+#include <gst/pylon/gstpyloncache.h>
+
+#ifdef G_OS_UNIX
+#  include <fcntl.h>
+#  include <sys/file.h>
+#  include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <vector>
+
+#define VERSION_GROUP "gstpylon"
+#define VERSION_KEY "version"
+#define CAMERA_KEY "camera"
+#define STREAM_KEY "stream"
+
+GstPylonDescriptionCache::GstPylonDescriptionCache()
+    : filepath(GstPylonCache::GetDirectory() + "/descriptions.ini"),
+      key_file(g_key_file_new()) {}
+
+GstPylonDescriptionCache::~GstPylonDescriptionCache() {
+  g_key_file_free(this->key_file);
+}
+
+gboolean GstPylonDescriptionCache::Load() {
+  GKeyFile *loaded = g_key_file_new();
+  gchar *version = NULL;
+  gboolean ret = FALSE;
+
+  if (!g_key_file_load_from_file(loaded, this->filepath.c_str(),
+                                 G_KEY_FILE_NONE, NULL)) {
+    g_key_file_free(loaded);
+    return FALSE;
+  }
+
+  /* Descriptions depend on the plugin version, start over on upgrades */
+  version = g_key_file_get_string(loaded, VERSION_GROUP, VERSION_KEY, NULL);
+  if (0 == g_strcmp0(version, VERSION)) {
+    g_key_file_free(this->key_file);
+    this->key_file = loaded;
+    ret = TRUE;
+  } else {
+    GST_INFO("Discarding device descriptions of version %s",
+             GST_STR_NULL(version));
+    g_key_file_free(loaded);
+  }
+
+  g_free(version);
+
+  return ret;
+}
+
+/* Serializes writers of different processes, the file itself is replaced
+ * on every write and can't be locked */
+gint GstPylonDescriptionCache::Lock() {
+#ifdef G_OS_UNIX
+  std::string lockpath = this->filepath + ".lock";
+  gint fd = g_open(lockpath.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0664);
+
+  if (fd < 0) {
+    GST_WARNING("Failed to open %s: %s", lockpath.c_str(), g_strerror(errno));
+    return -1;
+  }
+
+  while (0 != flock(fd, LOCK_EX)) {
+    if (EINTR != errno) {
+      GST_WARNING("Failed to lock %s: %s", lockpath.c_str(),
+                  g_strerror(errno));
+      break;
+    }
+  }
+
+  return fd;
+#else
+  return -1;
+#endif
+}
+
+void GstPylonDescriptionCache::Unlock(gint fd) {
+#ifdef G_OS_UNIX
+  if (fd >= 0) {
+    /* Closing the descriptor releases the lock */
+    close(fd);
+  }
+#endif
+}
+
+gboolean GstPylonDescriptionCache::Write(GError **err) {
+  gsize length = 0;
+  gchar *contents = NULL;
+  gboolean ret = FALSE;
+
+  g_key_file_set_string(this->key_file, VERSION_GROUP, VERSION_KEY, VERSION);
+  contents = g_key_file_to_data(this->key_file, &length, NULL);
+
+  /* Written to a temporary file and renamed, readers never see a partial
+   * file */
+#if defined(GLIB_VERSION_2_66) && GLIB_VERSION_MIN_REQUIRED >= GLIB_VERSION_2_66
+  ret = g_file_set_contents_full(
+      this->filepath.c_str(), contents, length,
+      static_cast<GFileSetContentsFlags>(G_FILE_SET_CONTENTS_CONSISTENT), 0666,
+      err);
+#else
+  ret = g_file_set_contents(this->filepath.c_str(), contents, length, err);
+#endif
+
+  g_free(contents);
+
+  return ret;
+}
+
+gboolean GstPylonDescriptionCache::Save(GError **err) {
+  gint fd = this->Lock();
+  gboolean ret = this->Write(err);
+
+  this->Unlock(fd);
+
+  return ret;
+}
+
+gboolean GstPylonDescriptionCache::AddDevice(const std::string &device_name,
+                                             const gchar *camera_description,
+                                             const gchar *stream_description,
+                                             GError **err) {
+  gint fd = this->Lock();
+  gboolean ret = FALSE;
+
+  /* Start from the latest file, other processes may have added devices */
+  if (!this->Load()) {
+    g_key_file_free(this->key_file);
+    this->key_file = g_key_file_new();
+  }
+
+  this->SetDevice(device_name, camera_description, stream_description);
+  ret = this->Write(err);
+
+  this->Unlock(fd);
+
+  return ret;
+}
+
+gboolean GstPylonDescriptionCache::HasDevice(const std::string &device_name) {
+  return g_key_file_has_group(this->key_file, device_name.c_str());
+}
+
+void GstPylonDescriptionCache::SetDevice(const std::string &device_name,
+                                         const gchar *camera_description,
+                                         const gchar *stream_description) {
+  g_key_file_set_string(this->key_file, device_name.c_str(), CAMERA_KEY,
+                        camera_description);
+  g_key_file_set_string(this->key_file, device_name.c_str(), STREAM_KEY,
+                        stream_description);
+}
+
+gchar *GstPylonDescriptionCache::GetDescriptions(const gchar *key) {
+  gchar **groups = g_key_file_get_groups(this->key_file, NULL);
+  std::vector<std::string> devices;
+  GString *descriptions = NULL;
+
+  for (gchar **group = groups; *group; group++) {
+    if (0 != g_strcmp0(*group, VERSION_GROUP)) {
+      devices.push_back(*group);
+    }
+  }
+  g_strfreev(groups);
+
+  /* Independent of the order devices were opened in */
+  std::sort(devices.begin(), devices.end());
+
+  for (const auto &device : devices) {
+    gchar *description =
+        g_key_file_get_string(this->key_file, device.c_str(), key, NULL);
+    if (!description) {
+      continue;
+    }
+
+    if (!descriptions) {
+      descriptions = g_string_new(description);
+    } else {
+      g_string_append_c(descriptions, '\n');
+      g_string_append(descriptions, description);
+    }
+    g_free(description);
+  }
+
+  return descriptions ? g_string_free(descriptions, FALSE) : NULL;
+}
+
+gchar *GstPylonDescriptionCache::GetCameraDescriptions() {
+  return this->GetDescriptions(CAMERA_KEY);
+}
+
+gchar *GstPylonDescriptionCache::GetStreamDescriptions() {
+  return this->GetDescriptions(STREAM_KEY);
+}
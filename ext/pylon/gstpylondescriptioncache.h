@@ -0,0 +1,78 @@
+/* Copyright (C) 2024 Basler AG
+ *
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *     1. Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *     2. Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *     3. Neither the name of the copyright holder nor the names of
+ *        its contributors may be used to endorse or promote products
+ *        derived from this software without specific prior written
+ *        permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef GST_PYLON_DESCRIPTION_CACHE_H
+#define GST_PYLON_DESCRIPTION_CACHE_H
+
+#include <gst/gst.h>
+
+#include <string>
+
+/* Property documentation of the cameras and stream grabbers seen so far,
+ * persisted so that the element class can document them without opening
+ * any device. Entries are added whenever a device is opened and the whole
+ * file is dropped when the plugin version changes. Writers hold a lock on
+ * the file and replace it atomically. */
+class GstPylonDescriptionCache {
+ public:
+  GstPylonDescriptionCache();
+  ~GstPylonDescriptionCache();
+
+  gboolean Load();
+  /* Replaces the file with the devices set on this cache */
+  gboolean Save(GError **err);
+  /* Adds a device to the file, keeping the devices other processes added
+   * since it was loaded */
+  gboolean AddDevice(const std::string &device_name,
+                     const gchar *camera_description,
+                     const gchar *stream_description, GError **err);
+
+  gboolean HasDevice(const std::string &device_name);
+  void SetDevice(const std::string &device_name,
+                 const gchar *camera_description,
+                 const gchar *stream_description);
+
+  /* Descriptions of all the devices in the cache, NULL if there are none */
+  gchar *GetCameraDescriptions();
+  gchar *GetStreamDescriptions();
+
+ private:
+  gchar *GetDescriptions(const gchar *key);
+  gint Lock();
+  void Unlock(gint fd);
+  gboolean Write(GError **err);
+
+  std::string filepath;
+  GKeyFile *key_file;
+};
+
+#endif
@@ -0,0 +1,261 @@
+/* Copyright (C) 2024 Basler AG
+ *
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *     1. Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *     2. Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *     3. Neither the name of the copyright holder nor the names of
+ *        its contributors may be used to endorse or promote products
+ *        derived from this software without specific prior written
+ *        permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "gst/pylon/gstpylondebug.h"
+#include "gstpylondmabufbufferfactory.h"
+
+#include <gst/allocators/gstdmabuf.h>
+
+#include <fcntl.h>
+#include <linux/dma-buf.h>
+#include <linux/dma-heap.h>
+#include <linux/udmabuf.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <cerrno>
+
+static constexpr const char *DMA_HEAP_PATH = "/dev/dma_heap/system";
+static constexpr const char *UDMABUF_PATH = "/dev/udmabuf";
+
+bool GstPylonDmaBufBufferFactory::IsSupported() {
+  return 0 == access(DMA_HEAP_PATH, R_OK | W_OK) ||
+         0 == access(UDMABUF_PATH, R_OK | W_OK);
+}
+
+GstPylonDmaBufBufferFactory::GstPylonDmaBufBufferFactory()
+    : allocator(gst_dmabuf_allocator_new()),
+      heap_fd(-1),
+      udmabuf_fd(-1),
+      page_size(sysconf(_SC_PAGESIZE)) {
+  this->heap_fd = open(DMA_HEAP_PATH, O_RDWR | O_CLOEXEC);
+  if (this->heap_fd >= 0) {
+    GST_INFO("Allocating dma-buf grab buffers from %s", DMA_HEAP_PATH);
+    return;
+  }
+
+  this->udmabuf_fd = open(UDMABUF_PATH, O_RDWR | O_CLOEXEC);
+  if (this->udmabuf_fd >= 0) {
+    GST_INFO("Allocating dma-buf grab buffers from memfd through %s",
+             UDMABUF_PATH);
+    return;
+  }
+
+  GST_ERROR("Neither %s nor %s are available, can't allocate dma-buf grab "
+            "buffers",
+            DMA_HEAP_PATH, UDMABUF_PATH);
+}
+
+GstPylonDmaBufBufferFactory::~GstPylonDmaBufBufferFactory() {
+  if (this->heap_fd >= 0) {
+    close(this->heap_fd);
+  }
+  if (this->udmabuf_fd >= 0) {
+    close(this->udmabuf_fd);
+  }
+  gst_object_unref(this->allocator);
+}
+
+int GstPylonDmaBufBufferFactory::AllocateFromHeap(size_t size) {
+  struct dma_heap_allocation_data data = {};
+
+  data.len = size;
+  data.fd_flags = O_RDWR | O_CLOEXEC;
+
+  if (ioctl(this->heap_fd, DMA_HEAP_IOCTL_ALLOC, &data) < 0) {
+    GST_ERROR("Failed to allocate %" G_GSIZE_FORMAT " bytes from %s: %s",
+              size, DMA_HEAP_PATH, g_strerror(errno));
+    return -1;
+  }
+
+  return data.fd;
+}
+
+int GstPylonDmaBufBufferFactory::AllocateFromMemfd(size_t size) {
+  int fd = memfd_create("pylon-grab-buffer", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+
+  if (fd < 0) {
+    GST_ERROR("Failed to create memfd: %s", g_strerror(errno));
+    return -1;
+  }
+
+  if (ftruncate(fd, size) < 0) {
+    GST_ERROR("Failed to resize memfd to %" G_GSIZE_FORMAT " bytes: %s", size,
+              g_strerror(errno));
+    close(fd);
+    return -1;
+  }
+
+  return fd;
+}
+
+int GstPylonDmaBufBufferFactory::AllocateFromUdmabuf(size_t size) {
+  struct udmabuf_create create = {};
+  int memfd = -1;
+  int fd = -1;
+
+  memfd = this->AllocateFromMemfd(size);
+  if (memfd < 0) {
+    return -1;
+  }
+
+  /* udmabuf refuses memfds that could shrink below the exported size */
+  if (fcntl(memfd, F_ADD_SEALS, F_SEAL_SHRINK) < 0) {
+    GST_ERROR("Failed to seal memfd: %s", g_strerror(errno));
+    close(memfd);
+    return -1;
+  }
+
+  create.memfd = memfd;
+  create.flags = UDMABUF_FLAGS_CLOEXEC;
+  create.offset = 0;
+  create.size = size;
+
+  fd = ioctl(this->udmabuf_fd, UDMABUF_CREATE, &create);
+  if (fd < 0) {
+    GST_ERROR("Failed to export memfd through %s: %s", UDMABUF_PATH,
+              g_strerror(errno));
+  }
+
+  /* The dma-buf keeps its own reference to the pages */
+  close(memfd);
+
+  return fd;
+}
+
+int GstPylonDmaBufBufferFactory::AllocateFd(size_t size) {
+  if (this->heap_fd >= 0) {
+    return this->AllocateFromHeap(size);
+  } else if (this->udmabuf_fd >= 0) {
+    return this->AllocateFromUdmabuf(size);
+  }
+
+  return -1;
+}
+
+void GstPylonDmaBufBufferFactory::Sync(intptr_t buffer_context, guint64 flags) {
+  GstMapInfo *info = reinterpret_cast<GstMapInfo *>(buffer_context);
+  struct dma_buf_sync sync = {};
+  int fd = -1;
+
+  if (!info) {
+    return;
+  }
+
+  fd = gst_dmabuf_memory_get_fd(info->memory);
+  sync.flags = flags;
+
+  while (ioctl(fd, DMA_BUF_IOCTL_SYNC, &sync) < 0) {
+    if (EINTR != errno && EAGAIN != errno) {
+      GST_WARNING("Failed to sync dma-buf fd %d: %s", fd, g_strerror(errno));
+      return;
+    }
+  }
+}
+
+void GstPylonDmaBufBufferFactory::AllocateBuffer(size_t buffer_size,
+                                                 void **p_created_buffer,
+                                                 intptr_t &buffer_context) {
+  GstMemory *mem = NULL;
+  GstMapInfo *info = NULL;
+  size_t fd_size = 0;
+  int fd = -1;
+
+  *p_created_buffer = nullptr;
+
+  /* All backends work in whole pages */
+  fd_size = (buffer_size + this->page_size - 1) & ~(this->page_size - 1);
+
+  fd = this->AllocateFd(fd_size);
+  if (fd < 0) {
+    return;
+  }
+
+  /* The memory takes ownership of the fd */
+  mem = gst_dmabuf_allocator_alloc(this->allocator, fd, buffer_size);
+  if (!mem) {
+    GST_ERROR("Unable to wrap dma-buf fd %d", fd);
+    close(fd);
+    return;
+  }
+
+  /* The mapping is kept for the lifetime of the grab buffer, pylon writes
+   * frames through it */
+  info = new GstMapInfo;
+  if (!gst_memory_map(mem, info, GST_MAP_READWRITE)) {
+    GST_ERROR("Unable to map dma-buf fd %d", fd);
+    delete info;
+    gst_memory_unref(mem);
+    return;
+  }
+
+  *p_created_buffer = info->data;
+  buffer_context = reinterpret_cast<intptr_t>(info);
+
+  /* New buffers go straight to pylon */
+  this->BeginWrite(*p_created_buffer, buffer_context);
+}
+
+void GstPylonDmaBufBufferFactory::FreeBuffer(void *p_created_buffer,
+                                             intptr_t buffer_context) {
+  GstMapInfo *info = reinterpret_cast<GstMapInfo *>(buffer_context);
+  GstMemory *mem = NULL;
+
+  if (!info) {
+    return;
+  }
+
+  mem = info->memory;
+  gst_memory_unmap(mem, info);
+  gst_memory_unref(mem);
+  delete info;
+}
+
+void GstPylonDmaBufBufferFactory::DestroyBufferFactory() { delete this; }
+
+void GstPylonDmaBufBufferFactory::BeginWrite(void *p_created_buffer,
+                                             intptr_t buffer_context) {
+  this->Sync(buffer_context, DMA_BUF_SYNC_START | DMA_BUF_SYNC_WRITE);
+}
+
+void GstPylonDmaBufBufferFactory::EndWrite(void *p_created_buffer,
+                                           intptr_t buffer_context) {
+  this->Sync(buffer_context, DMA_BUF_SYNC_END | DMA_BUF_SYNC_WRITE);
+}
+
+GstMemory *GstPylonDmaBufBufferFactory::GetMemory(void *p_created_buffer,
+                                                  intptr_t buffer_context) {
+  GstMapInfo *info = reinterpret_cast<GstMapInfo *>(buffer_context);
+
+  return info ? info->memory : NULL;
+}
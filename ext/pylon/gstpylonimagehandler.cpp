@@ -30,41 +30,293 @@
  * OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include "gst/pylon/gstpylondebug.h"
 #include "gstpylonimagehandler.h"
+#include "gstpylonthread.h"
+
+#include <algorithm>
 
 GstPylonImageHandler::GstPylonImageHandler()
-    : ptr_grab_result(NULL), grab_result_ready(false) {}
+    : capacity(0),
+      policy(PROP_GRAB_QUEUE_POLICY_DEFAULT),
+      enqueue_pos(0),
+      dequeue_pos(0),
+      dropped(0),
+      grabbed(0),
+      consumer_waiting(false),
+      producer_waiting(false),
+      interrupted(false),
+      stopped(false),
+      interrupt_wait(Pylon::WaitObjectEx::Create()),
+      interrupt_index(0),
+      affinity_pending(false) {
+  this->SetQueueConfiguration(PROP_GRAB_QUEUE_DEPTH_DEFAULT,
+                              PROP_GRAB_QUEUE_POLICY_DEFAULT);
+}
+
+GstPylonImageHandler::~GstPylonImageHandler() { this->Drain(); }
+
+void GstPylonImageHandler::SetQueueConfiguration(
+    guint depth, GstPylonQueuePolicyEnum policy) {
+  this->Drain();
+
+  this->capacity = std::max(depth, 1U);
+  this->policy = policy;
+  this->slots.reset(new Slot[this->capacity]);
+  for (size_t i = 0; i < this->capacity; i++) {
+    this->slots[i].sequence.store(i, std::memory_order_relaxed);
+  }
+  this->enqueue_pos.store(0, std::memory_order_relaxed);
+  this->dequeue_pos.store(0, std::memory_order_relaxed);
+}
+
+void GstPylonImageHandler::Start() {
+  /* Release results left behind by a grab thread that raced with Stop() */
+  this->Drain();
+  this->dropped.store(0);
+  this->grabbed.store(0);
+  this->stopped.store(false);
+  this->affinity_pending.store(!this->grab_thread_affinity.empty());
+}
+
+void GstPylonImageHandler::Stop() {
+  this->stopped.store(true);
+
+  /* Release a grab thread blocked on a full queue, otherwise stopping the
+   * grab loop would wait on it forever */
+  std::unique_lock<std::mutex> mutex_lock(this->wait_mutex);
+  mutex_lock.unlock();
+  this->space_cv.notify_all();
+
+  this->Drain();
+}
+
+guint64 GstPylonImageHandler::GetDroppedCount() { return this->dropped.load(); }
+
+guint64 GstPylonImageHandler::GetGrabbedCount() { return this->grabbed.load(); }
+
+void GstPylonImageHandler::SetGrabThreadAffinity(const std::string &cpu_list) {
+  this->grab_thread_affinity = cpu_list;
+}
+
+bool GstPylonImageHandler::Enqueue(
+    const Pylon::CBaslerUniversalGrabResultPtr &grab_result, gint64 grab_time) {
+  size_t pos = this->enqueue_pos.load(std::memory_order_relaxed);
+  Slot *slot = NULL;
+
+  for (;;) {
+    slot = &this->slots[pos % this->capacity];
+    size_t seq = slot->sequence.load(std::memory_order_acquire);
+    intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+
+    if (0 == diff) {
+      if (this->enqueue_pos.compare_exchange_weak(pos, pos + 1,
+                                                  std::memory_order_relaxed)) {
+        break;
+      }
+    } else if (diff < 0) {
+      /* Queue is full */
+      return false;
+    } else {
+      pos = this->enqueue_pos.load(std::memory_order_relaxed);
+    }
+  }
+
+  slot->grab_result = grab_result;
+  slot->grab_time = grab_time;
+  slot->sequence.store(pos + 1, std::memory_order_release);
+
+  return true;
+}
+
+bool GstPylonImageHandler::Dequeue(
+    Pylon::CBaslerUniversalGrabResultPtr &grab_result, gint64 &grab_time) {
+  size_t pos = this->dequeue_pos.load(std::memory_order_relaxed);
+  Slot *slot = NULL;
+
+  for (;;) {
+    slot = &this->slots[pos % this->capacity];
+    size_t seq = slot->sequence.load(std::memory_order_acquire);
+    intptr_t diff =
+        static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+
+    if (0 == diff) {
+      if (this->dequeue_pos.compare_exchange_weak(pos, pos + 1,
+                                                  std::memory_order_relaxed)) {
+        break;
+      }
+    } else if (diff < 0) {
+      /* Queue is empty */
+      return false;
+    } else {
+      pos = this->dequeue_pos.load(std::memory_order_relaxed);
+    }
+  }
+
+  grab_result = slot->grab_result;
+  grab_time = slot->grab_time;
+  slot->grab_result.Release();
+  slot->sequence.store(pos + this->capacity, std::memory_order_release);
+
+  return true;
+}
+
+bool GstPylonImageHandler::HasData() {
+  size_t pos = this->dequeue_pos.load(std::memory_order_relaxed);
+  const Slot &slot = this->slots[pos % this->capacity];
+
+  return slot.sequence.load(std::memory_order_acquire) == pos + 1;
+}
+
+bool GstPylonImageHandler::HasSpace() {
+  size_t pos = this->enqueue_pos.load(std::memory_order_relaxed);
+  const Slot &slot = this->slots[pos % this->capacity];
+
+  return slot.sequence.load(std::memory_order_acquire) == pos;
+}
+
+void GstPylonImageHandler::Drain() {
+  Pylon::CBaslerUniversalGrabResultPtr grab_result;
+  gint64 grab_time = 0;
+
+  if (!this->slots) {
+    return;
+  }
+
+  while (this->Dequeue(grab_result, grab_time)) {
+    grab_result.Release();
+  }
+}
 
 void GstPylonImageHandler::OnImageGrabbed(
     Pylon::CBaslerUniversalInstantCamera &camera,
     const Pylon::CBaslerUniversalGrabResultPtr &grab_result) {
-  std::unique_lock<std::mutex> mutex_lock(this->grab_result_mutex);
-  /* Return if an interrupt was received */
-  if (this->grab_result_ready) {
-    return;
-  };
-  this->ptr_grab_result = new Pylon::CBaslerUniversalGrabResultPtr(grab_result);
-  this->grab_result_ready = true;
-  mutex_lock.unlock();
-  this->grab_result_cv.notify_one();
+  const gint64 grab_time = g_get_monotonic_time();
+
+  this->grabbed.fetch_add(1, std::memory_order_relaxed);
+
+  if (this->affinity_pending.load(std::memory_order_relaxed) &&
+      this->affinity_pending.exchange(false)) {
+    GError *error = NULL;
+    if (!gst_pylon_thread_set_affinity(this->grab_thread_affinity.c_str(),
+                                       &error)) {
+      GST_WARNING("Unable to pin grab thread: %s", error->message);
+      g_error_free(error);
+    }
+  }
+
+  while (!this->Enqueue(grab_result, grab_time)) {
+    if (this->stopped.load() || ENUM_QUEUE_DROP_NEWEST == this->policy) {
+      this->dropped.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+
+    if (ENUM_QUEUE_DROP_OLDEST == this->policy) {
+      Pylon::CBaslerUniversalGrabResultPtr oldest;
+      gint64 oldest_time = 0;
+      if (this->Dequeue(oldest, oldest_time)) {
+        this->dropped.fetch_add(1, std::memory_order_relaxed);
+      }
+    } else {
+      /* Block the grab thread until the streaming thread frees a slot, the
+       * driver side queue absorbs the frames in the meantime */
+      std::unique_lock<std::mutex> mutex_lock(this->wait_mutex);
+      this->producer_waiting.store(true);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      this->space_cv.wait(mutex_lock, [this] {
+        return this->stopped.load() || this->HasSpace();
+      });
+      this->producer_waiting.store(false);
+    }
+  }
+
+  /* Only take the lock if the streaming thread is actually asleep */
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (this->consumer_waiting.load()) {
+    std::unique_lock<std::mutex> mutex_lock(this->wait_mutex);
+    mutex_lock.unlock();
+    this->data_cv.notify_one();
+  }
 }
 
-Pylon::CBaslerUniversalGrabResultPtr *GstPylonImageHandler::WaitForImage() {
-  std::unique_lock<std::mutex> mutex_lock(this->grab_result_mutex);
-  this->grab_result_cv.wait(mutex_lock,
-                            [this] { return this->grab_result_ready; });
-  Pylon::CBaslerUniversalGrabResultPtr *grab_result = this->ptr_grab_result;
-  this->ptr_grab_result = NULL;
-  this->grab_result_ready = false;
-  mutex_lock.unlock();
+bool GstPylonImageHandler::WaitForImage(
+    Pylon::CBaslerUniversalGrabResultPtr &grab_result, gint64 &grab_time) {
+  for (;;) {
+    /* Return if an interrupt was received */
+    if (this->interrupted.exchange(false)) {
+      return false;
+    }
 
-  return grab_result;
-};
+    if (this->Dequeue(grab_result, grab_time)) {
+      break;
+    }
+
+    std::unique_lock<std::mutex> mutex_lock(this->wait_mutex);
+    this->consumer_waiting.store(true);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    this->data_cv.wait(mutex_lock, [this] {
+      return this->interrupted.load() || this->HasData();
+    });
+    this->consumer_waiting.store(false);
+  }
+
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (this->producer_waiting.load()) {
+    std::unique_lock<std::mutex> mutex_lock(this->wait_mutex);
+    mutex_lock.unlock();
+    this->space_cv.notify_one();
+  }
+
+  return true;
+}
+
+void GstPylonImageHandler::SetRetrieveWaitObject(
+    const Pylon::WaitObject &grab_result_wait) {
+  this->retrieve_waits.RemoveAll();
+  this->retrieve_waits.Add(grab_result_wait);
+  this->interrupt_index = this->retrieve_waits.Add(this->interrupt_wait);
+}
+
+bool GstPylonImageHandler::RetrieveImage(
+    Pylon::CBaslerUniversalInstantCamera &camera,
+    Pylon::CBaslerUniversalGrabResultPtr &grab_result, gint64 &grab_time) {
+  /* Bounded wait so a grab that stopped without an interrupt is noticed */
+  static const unsigned int wait_timeout_ms = 1000;
+  unsigned int index = 0;
+
+  for (;;) {
+    /* Return if an interrupt was received */
+    if (this->interrupted.exchange(false)) {
+      return false;
+    }
+
+    if (!camera.IsGrabbing()) {
+      return false;
+    }
+
+    if (!this->retrieve_waits.WaitForAny(wait_timeout_ms, &index)) {
+      continue;
+    }
+
+    if (this->interrupt_index == index) {
+      /* The flag is checked again after the reset, so no interrupt is lost */
+      this->interrupt_wait.Reset();
+      continue;
+    }
+
+    if (camera.RetrieveResult(0, grab_result, Pylon::TimeoutHandling_Return)) {
+      grab_time = g_get_monotonic_time();
+      this->grabbed.fetch_add(1, std::memory_order_relaxed);
+      return true;
+    }
+  }
+}
 
 void GstPylonImageHandler::InterruptWaitForImage() {
-  std::unique_lock<std::mutex> mutex_lock(this->grab_result_mutex);
-  this->grab_result_ready = true;
-  mutex_lock.unlock();
+  this->interrupted.store(true);
+  this->interrupt_wait.Signal();
 
-  this->grab_result_cv.notify_one();
+  std::unique_lock<std::mutex> mutex_lock(this->wait_mutex);
+  mutex_lock.unlock();
+  this->data_cv.notify_one();
 }
@@ -33,25 +33,91 @@
 #ifndef _GST_PYLON_IMAGE_HANDLER_H_
 #define _GST_PYLON_IMAGE_HANDLER_H_
 
+#include "gstpylon.h"
+
 #include <gst/pylon/gstpylonincludes.h>
 
+#include <atomic>
 #include <condition_variable>
+#include <memory>
 #include <mutex>
+#include <string>
 
 class GstPylonImageHandler : public Pylon::CBaslerUniversalImageEventHandler {
  public:
   GstPylonImageHandler();
+  ~GstPylonImageHandler();
   void OnImageGrabbed(
       Pylon::CBaslerUniversalInstantCamera &camera,
       const Pylon::CBaslerUniversalGrabResultPtr &grab_result) override;
-  Pylon::CBaslerUniversalGrabResultPtr *WaitForImage();
+  /* grab_time is the monotonic time at which the result left the driver */
+  bool WaitForImage(Pylon::CBaslerUniversalGrabResultPtr &grab_result,
+                    gint64 &grab_time);
   void InterruptWaitForImage();
 
+  /* Retrieve results directly from the calling thread when the grab loop is
+   * provided by the user, the handler must not be registered in this case */
+  void SetRetrieveWaitObject(const Pylon::WaitObject &grab_result_wait);
+  bool RetrieveImage(Pylon::CBaslerUniversalInstantCamera &camera,
+                     Pylon::CBaslerUniversalGrabResultPtr &grab_result,
+                     gint64 &grab_time);
+
+  /* Queue handling, SetQueueConfiguration must only be called while the
+   * camera is not grabbing */
+  void SetQueueConfiguration(guint depth, GstPylonQueuePolicyEnum policy);
+  void Start();
+  void Stop();
+  guint64 GetDroppedCount();
+  guint64 GetGrabbedCount();
+
+  /* Pin the pylon grab loop thread, which is only known once it delivers
+   * the first image after Start() */
+  void SetGrabThreadAffinity(const std::string &cpu_list);
+
  private:
-  std::mutex grab_result_mutex;
-  std::condition_variable grab_result_cv;
-  Pylon::CBaslerUniversalGrabResultPtr *ptr_grab_result;
-  bool grab_result_ready;
+  /* Bounded ring of grab results between the pylon grab thread and the
+   * streaming thread. The slots follow the sequence protocol of a bounded
+   * MPMC queue, because with the drop-oldest policy the producer also acts as
+   * a consumer of the oldest entry. Results are held by value in slots
+   * allocated once per configuration, so grabbing doesn't allocate. */
+  struct Slot {
+    std::atomic<size_t> sequence;
+    Pylon::CBaslerUniversalGrabResultPtr grab_result;
+    gint64 grab_time;
+  };
+
+  bool Enqueue(const Pylon::CBaslerUniversalGrabResultPtr &grab_result,
+               gint64 grab_time);
+  bool Dequeue(Pylon::CBaslerUniversalGrabResultPtr &grab_result,
+               gint64 &grab_time);
+  bool HasData();
+  bool HasSpace();
+  void Drain();
+
+  std::unique_ptr<Slot[]> slots;
+  size_t capacity;
+  GstPylonQueuePolicyEnum policy;
+  std::atomic<size_t> enqueue_pos;
+  std::atomic<size_t> dequeue_pos;
+  std::atomic<guint64> dropped;
+  std::atomic<guint64> grabbed;
+
+  /* Slow path used only if one side has to sleep */
+  std::mutex wait_mutex;
+  std::condition_variable data_cv;
+  std::condition_variable space_cv;
+  std::atomic<bool> consumer_waiting;
+  std::atomic<bool> producer_waiting;
+  std::atomic<bool> interrupted;
+  std::atomic<bool> stopped;
+
+  /* Wakes up RetrieveImage, signaled together with the interrupted flag */
+  Pylon::WaitObjectEx interrupt_wait;
+  Pylon::WaitObjects retrieve_waits;
+  unsigned int interrupt_index;
+
+  std::string grab_thread_affinity;
+  std::atomic<bool> affinity_pending;
 };
 
 #endif
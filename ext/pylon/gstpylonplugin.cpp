@@ -36,10 +36,24 @@
 
 #include "version.h"
 
+#include "gst/pylon/gstpylondebug.h"
+#include "gst/pylon/gstpylonincludes.h"
+#include "gstpylon.h"
 #include "gstpylonsrc.h"
 #include <pylon/PylonVersionNumber.h>
 
 static gboolean plugin_init(GstPlugin* plugin) {
+  /* Opening all connected devices takes seconds and resets devices other
+   * processes are using, so the descriptions are only refreshed on request.
+   * This must happen before the element class is initialized, the refresh
+   * creates types and waits for other threads. */
+  if (g_getenv("GST_PYLON_REFRESH_DESCRIPTIONS")) {
+    Pylon::PylonAutoInitTerm init_pylon;
+
+    gst_pylon_debug_init();
+    gst_pylon_refresh_descriptions();
+  }
+
   return gst_element_register(plugin, "pylonsrc", GST_RANK_NONE,
                               GST_TYPE_PYLON_SRC);
 }
@@ -50,17 +50,28 @@
 
 #include "gst/pylon/gstpylondebug.h"
 #include "gst/pylon/gstpylonmeta.h"
+#include "gst/pylon/gstpylonmetaprivate.h"
 #include "gstpylon.h"
+#include "gstpylonbufferpool.h"
 #include "gstpylonsrc.h"
+#include "gstpylonthread.h"
+#include "gstpylontimestampmapper.h"
 
 #include <gst/pylon/gstpylonincludes.h>
 #include <gst/video/video.h>
 
+/* Number of measured delays the reported latency is based on, and how far
+ * it may drift before a new latency is requested */
+#define LATENCY_WINDOW 64
+#define LATENCY_DRIFT_MIN GST_MSECOND
+#define LATENCY_DRIFT_DIVISOR 10
+
 struct _GstPylonSrc {
   GstPushSrc base_pylonsrc;
   GstPylon *pylon;
   GstClockTime duration;
   GstVideoInfo video_info;
+  GstCaps *timestamp_caps;
 
   gchar *device_user_name;
   gchar *device_serial_number;
@@ -69,6 +80,45 @@ struct _GstPylonSrc {
   gchar *pfs_location;
   gboolean enable_correction;
   GstPylonCaptureErrorEnum capture_error;
+  guint grab_queue_depth;
+  GstPylonQueuePolicyEnum grab_queue_policy;
+  GstPylonGrabStrategyEnum grab_strategy;
+  guint output_queue_size;
+  GstPylonCaptureModeEnum capture_mode;
+  GstAllocator *allocator;
+  GstPylonMemoryPagesEnum memory_pages;
+  gboolean memory_lock;
+  gint numa_node;
+  gchar *grab_thread_affinity;
+  gint grab_thread_priority;
+  gchar *streaming_thread_affinity;
+  /* Affinity the streaming thread had before it was pinned, only used by
+   * the streaming thread */
+  gchar *saved_affinity;
+  gboolean use_arena;
+  guint64 arena_reservation;
+  GstPylonBufferCountModeEnum buffer_count_mode;
+  GstClockTime target_latency;
+  guint64 buffer_memory_limit;
+  GstClockTime pipeline_latency;
+  GstClockTime sized_latency;
+  gchar **chunk_request;
+  GstPylonTimestampModeEnum timestamp_mode;
+  GstPylonTimestampMapper *timestamp_mapper;
+  gboolean timestamp_latching;
+  GstClockTime latch_interval;
+  GstClockTime last_latch_time;
+  GstClockTime last_timestamp;
+
+  /* Latency of the current configuration, refined by the delays measured
+   * between exposure start and push */
+  GstClockTime capture_latency;
+  GstClockTime reported_latency;
+  GstClockTime latency_window[LATENCY_WINDOW];
+  guint latency_window_next;
+  guint latency_window_count;
+  guint stats_interval;
+  gint64 last_stats_time;
   GObject *cam;
   GObject *stream;
 
@@ -96,7 +146,11 @@ static gboolean gst_pylon_src_start(GstBaseSrc *src);
 static gboolean gst_pylon_src_stop(GstBaseSrc *src);
 static gboolean gst_pylon_src_unlock(GstBaseSrc *src);
 static gboolean gst_pylon_src_query(GstBaseSrc *src, GstQuery *query);
+static gboolean gst_pylon_src_event(GstBaseSrc *src, GstEvent *event);
+static gboolean gst_pylon_src_post_message(GstElement *element,
+                                           GstMessage *message);
 static void gst_plyon_src_add_metadata(GstPylonSrc *self, GstBuffer *buf);
+static GstClockTime gst_pylon_src_get_min_latency(GstPylonSrc *self);
 static GstFlowReturn gst_pylon_src_create(GstPushSrc *src, GstBuffer **buf);
 
 static void gst_pylon_src_child_proxy_init(GstChildProxyInterface *iface);
@@ -110,6 +164,27 @@ enum {
   PROP_PFS_LOCATION,
   PROP_ENABLE_CORRECTION,
   PROP_CAPTURE_ERROR,
+  PROP_GRAB_QUEUE_DEPTH,
+  PROP_GRAB_QUEUE_POLICY,
+  PROP_GRAB_STRATEGY,
+  PROP_OUTPUT_QUEUE_SIZE,
+  PROP_CAPTURE_MODE,
+  PROP_ALLOCATOR,
+  PROP_MEMORY_PAGES,
+  PROP_MEMORY_LOCK,
+  PROP_NUMA_NODE,
+  PROP_GRAB_THREAD_AFFINITY,
+  PROP_GRAB_THREAD_PRIORITY,
+  PROP_STREAMING_THREAD_AFFINITY,
+  PROP_USE_ARENA,
+  PROP_ARENA_RESERVATION,
+  PROP_ARENA_BUDGET,
+  PROP_BUFFER_COUNT_MODE,
+  PROP_TARGET_LATENCY,
+  PROP_BUFFER_MEMORY_LIMIT,
+  PROP_TIMESTAMP_MODE,
+  PROP_STATS,
+  PROP_STATS_INTERVAL,
   PROP_CAM,
   PROP_STREAM,
 #ifdef NVMM_ENABLED
@@ -127,8 +202,28 @@ enum {
 #define PROP_PFS_LOCATION_DEFAULT NULL
 #define PROP_ENABLE_CORRECTION_DEFAULT TRUE
 #define PROP_CAM_DEFAULT NULL
+#define PROP_ALLOCATOR_DEFAULT NULL
 #define PROP_STREAM_DEFAULT NULL
 #define PROP_CAPTURE_ERROR_DEFAULT ENUM_ABORT
+#define PROP_GRAB_QUEUE_DEPTH_MIN 1
+#define PROP_GRAB_QUEUE_DEPTH_MAX 256
+#define PROP_OUTPUT_QUEUE_SIZE_MIN 1
+#define PROP_OUTPUT_QUEUE_SIZE_MAX G_MAXUINT32
+#define PROP_NUMA_NODE_MIN -1
+#define PROP_NUMA_NODE_MAX 1023
+#define PROP_GRAB_THREAD_AFFINITY_DEFAULT NULL
+#define PROP_GRAB_THREAD_PRIORITY_MIN 0
+#define PROP_GRAB_THREAD_PRIORITY_MAX 99
+#define PROP_STREAMING_THREAD_AFFINITY_DEFAULT NULL
+#define PROP_STATS_INTERVAL_DEFAULT 0
+
+/* Camera to pipeline clock mapping, latched samples are taken periodically
+ * while frame arrival samples are taken for every frame. Failed latches are
+ * retried with an interval that doubles up to the maximum. */
+#define TIMESTAMP_LATCH_INTERVAL GST_SECOND
+#define TIMESTAMP_LATCH_RETRY_MAX (64 * GST_SECOND)
+#define TIMESTAMP_LATCH_WINDOW 32
+#define TIMESTAMP_ARRIVAL_WINDOW 256
 #ifdef NVMM_ENABLED
 #  define PROP_GPU_ID_MIN 0
 #  define PROP_GPU_ID_MAX G_MAXUINT32
@@ -158,6 +253,78 @@ static GType gst_pylon_capture_error_enum_get_type(void) {
   return (GType)gtype;
 }
 
+/* Enum for grab_queue_policy */
+#define GST_TYPE_QUEUE_POLICY_ENUM (gst_pylon_queue_policy_enum_get_type())
+
+static GType gst_pylon_queue_policy_enum_get_type(void) {
+  static gsize gtype = 0;
+  static const GEnumValue values[] = {
+      {ENUM_QUEUE_DROP_OLDEST, "drop-oldest",
+       "Discard the oldest queued frame to make room for the new one"},
+      {ENUM_QUEUE_DROP_NEWEST, "drop-newest",
+       "Discard the newly grabbed frame if the queue is full"},
+      {ENUM_QUEUE_BLOCK, "block",
+       "Stall the grab thread until the queue has room, frames pile up in the "
+       "stream grabber buffers meanwhile"},
+      {0, NULL, NULL}};
+
+  if (g_once_init_enter(&gtype)) {
+    GType tmp = g_enum_register_static("GstPylonQueuePolicyEnum", values);
+    g_once_init_leave(&gtype, tmp);
+  }
+
+  return (GType)gtype;
+}
+
+/* Enum for grab_strategy */
+#define GST_TYPE_GRAB_STRATEGY_ENUM (gst_pylon_grab_strategy_enum_get_type())
+
+static GType gst_pylon_grab_strategy_enum_get_type(void) {
+  static gsize gtype = 0;
+  static const GEnumValue values[] = {
+      {ENUM_GRAB_ONE_BY_ONE, "one-by-one",
+       "Process images in the order of their arrival, no image is dropped "
+       "while grab buffers are available"},
+      {ENUM_GRAB_LATEST_IMAGE_ONLY, "latest-image-only",
+       "Keep only the latest grabbed image, older ones are dropped"},
+      {ENUM_GRAB_LATEST_IMAGES, "latest-images",
+       "Keep the last output-queue-size images, older ones are dropped"},
+      {ENUM_GRAB_UPCOMING_IMAGE, "upcoming-image",
+       "Only grab images requested after the pipeline waits for one, lowest "
+       "trigger to buffer latency. Requires capture-mode=streaming-thread, "
+       "not supported by USB cameras"},
+      {0, NULL, NULL}};
+
+  if (g_once_init_enter(&gtype)) {
+    GType tmp = g_enum_register_static("GstPylonGrabStrategyEnum", values);
+    g_once_init_leave(&gtype, tmp);
+  }
+
+  return (GType)gtype;
+}
+
+/* Enum for capture_mode */
+#define GST_TYPE_CAPTURE_MODE_ENUM (gst_pylon_capture_mode_enum_get_type())
+
+static GType gst_pylon_capture_mode_enum_get_type(void) {
+  static gsize gtype = 0;
+  static const GEnumValue values[] = {
+      {ENUM_CAPTURE_GRAB_THREAD, "grab-thread",
+       "Frames are grabbed by a pylon thread and handed over through the grab "
+       "queue"},
+      {ENUM_CAPTURE_STREAMING_THREAD, "streaming-thread",
+       "Frames are retrieved directly in the streaming thread, saving one "
+       "thread hand-off per frame. The grab queue is not used"},
+      {0, NULL, NULL}};
+
+  if (g_once_init_enter(&gtype)) {
+    GType tmp = g_enum_register_static("GstPylonCaptureModeEnum", values);
+    g_once_init_leave(&gtype, tmp);
+  }
+
+  return (GType)gtype;
+}
+
 #ifdef NVMM_ENABLED
 #  define GST_TYPE_NVSURFACE_LAYOUT_ENUM \
     (gst_pylon_nvsurface_layout_enum_get_type())
@@ -178,6 +345,71 @@ static GType gst_pylon_nvsurface_layout_enum_get_type(void) {
 }
 #endif
 
+/* Enum for memory_pages */
+#define GST_TYPE_MEMORY_PAGES_ENUM (gst_pylon_memory_pages_enum_get_type())
+
+static GType gst_pylon_memory_pages_enum_get_type(void) {
+  static gsize gtype = 0;
+  static const GEnumValue values[] = {
+      {ENUM_PAGES_NORMAL, "normal", "Grab buffers use regular pages"},
+      {ENUM_PAGES_TRANSPARENT_HUGE, "transparent-huge",
+       "Grab buffers are aligned to and advised for transparent huge pages"},
+      {ENUM_PAGES_HUGE, "huge",
+       "Grab buffers are mapped from the reserved huge page pool, falling "
+       "back to transparent huge pages if it is exhausted"},
+      {0, NULL, NULL}};
+
+  if (g_once_init_enter(&gtype)) {
+    GType tmp = g_enum_register_static("GstPylonMemoryPagesEnum", values);
+    g_once_init_leave(&gtype, tmp);
+  }
+
+  return (GType)gtype;
+}
+
+/* Enum for buffer_count_mode */
+#define GST_TYPE_BUFFER_COUNT_MODE_ENUM \
+  (gst_pylon_buffer_count_mode_enum_get_type())
+
+static GType gst_pylon_buffer_count_mode_enum_get_type(void) {
+  static gsize gtype = 0;
+  static const GEnumValue values[] = {
+      {ENUM_BUFFER_COUNT_MANUAL, "manual",
+       "Use the MaxNumBuffer of the stream grabber"},
+      {ENUM_BUFFER_COUNT_AUTO, "auto",
+       "Derive MaxNumBuffer from the framerate, the target latency and the "
+       "buffer memory limit"},
+      {0, NULL, NULL}};
+
+  if (g_once_init_enter(&gtype)) {
+    GType tmp = g_enum_register_static("GstPylonBufferCountModeEnum", values);
+    g_once_init_leave(&gtype, tmp);
+  }
+
+  return (GType)gtype;
+}
+
+/* Enum for timestamp_mode */
+#define GST_TYPE_TIMESTAMP_MODE_ENUM (gst_pylon_timestamp_mode_enum_get_type())
+
+static GType gst_pylon_timestamp_mode_enum_get_type(void) {
+  static gsize gtype = 0;
+  static const GEnumValue values[] = {
+      {ENUM_TIMESTAMP_PIPELINE_CLOCK, "pipeline-clock",
+       "Timestamp buffers with the pipeline clock when they are created"},
+      {ENUM_TIMESTAMP_CAMERA_CLOCK, "camera-clock",
+       "Timestamp buffers with the camera timestamp of the frame, mapped "
+       "onto the pipeline clock"},
+      {0, NULL, NULL}};
+
+  if (g_once_init_enter(&gtype)) {
+    GType tmp = g_enum_register_static("GstPylonTimestampModeEnum", values);
+    g_once_init_leave(&gtype, tmp);
+  }
+
+  return (GType)gtype;
+}
+
 /* pad templates */
 // clang-format off
 #ifdef NVMM_ENABLED
@@ -186,6 +418,14 @@ static GType gst_pylon_nvsurface_layout_enum_get_type(void) {
                                           " {GRAY8, RGB, BGR, YUY2, UYVY} ")
 #else
 #  define NVMM_GST_VIDEO_CAPS
+#endif
+
+#ifdef DMABUF_ENABLED
+#  define DMABUF_GST_VIDEO_CAPS                  ";"       \
+        GST_VIDEO_CAPS_MAKE_WITH_FEATURES("memory:DMABuf", \
+                                          " {GRAY8, RGB, BGR, YUY2, UYVY} ")
+#else
+#  define DMABUF_GST_VIDEO_CAPS
 #endif
 
  static GstStaticPadTemplate gst_pylon_src_src_template =
@@ -201,6 +441,7 @@ static GType gst_pylon_nvsurface_layout_enum_get_type(void) {
                                                ",framerate"
                                                "=" GST_VIDEO_FPS_RANGE
                                                NVMM_GST_VIDEO_CAPS
+                                               DMABUF_GST_VIDEO_CAPS
          )
     );
 // clang-format on
@@ -213,6 +454,7 @@ G_DEFINE_TYPE_WITH_CODE(GstPylonSrc, gst_pylon_src, GST_TYPE_PUSH_SRC,
 
 static void gst_pylon_src_class_init(GstPylonSrcClass *klass) {
   GObjectClass *gobject_class = G_OBJECT_CLASS(klass);
+  GstElementClass *element_class = GST_ELEMENT_CLASS(klass);
   GstBaseSrcClass *base_src_class = GST_BASE_SRC_CLASS(klass);
   GstPushSrcClass *push_src_class = GST_PUSH_SRC_CLASS(klass);
   gchar *cam_params = NULL;
@@ -311,6 +553,227 @@ static void gst_pylon_src_class_init(GstPylonSrcClass *klass) {
           GST_TYPE_CAPTURE_ERROR_ENUM, PROP_CAPTURE_ERROR_DEFAULT,
           static_cast<GParamFlags>(G_PARAM_READWRITE |
                                    GST_PARAM_CONTROLLABLE)));
+
+  g_object_class_install_property(
+      gobject_class, PROP_GRAB_QUEUE_DEPTH,
+      g_param_spec_uint(
+          "grab-queue-depth", "Grab queue depth",
+          "Number of grabbed frames that can wait between the camera grab "
+          "thread and the streaming thread before the grab queue policy "
+          "applies.",
+          PROP_GRAB_QUEUE_DEPTH_MIN, PROP_GRAB_QUEUE_DEPTH_MAX,
+          PROP_GRAB_QUEUE_DEPTH_DEFAULT,
+          static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+                                   GST_PARAM_MUTABLE_READY)));
+
+  g_object_class_install_property(
+      gobject_class, PROP_GRAB_QUEUE_POLICY,
+      g_param_spec_enum(
+          "grab-queue-policy", "Grab queue policy",
+          "The strategy to use when a frame is grabbed and the grab queue is "
+          "full.",
+          GST_TYPE_QUEUE_POLICY_ENUM, PROP_GRAB_QUEUE_POLICY_DEFAULT,
+          static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+                                   GST_PARAM_MUTABLE_READY)));
+
+  g_object_class_install_property(
+      gobject_class, PROP_GRAB_STRATEGY,
+      g_param_spec_enum(
+          "grab-strategy", "Grab strategy",
+          "The pylon grab strategy that decides which grabbed images are "
+          "delivered and which are dropped.",
+          GST_TYPE_GRAB_STRATEGY_ENUM, PROP_GRAB_STRATEGY_DEFAULT,
+          static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+                                   GST_PARAM_MUTABLE_READY)));
+
+  g_object_class_install_property(
+      gobject_class, PROP_OUTPUT_QUEUE_SIZE,
+      g_param_spec_uint(
+          "output-queue-size", "Output queue size",
+          "Number of images kept by the latest-images grab strategy. Must not "
+          "exceed the stream grabber MaxNumBuffer.",
+          PROP_OUTPUT_QUEUE_SIZE_MIN, PROP_OUTPUT_QUEUE_SIZE_MAX,
+          PROP_OUTPUT_QUEUE_SIZE_DEFAULT,
+          static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+                                   GST_PARAM_MUTABLE_READY)));
+
+  g_object_class_install_property(
+      gobject_class, PROP_CAPTURE_MODE,
+      g_param_spec_enum(
+          "capture-mode", "Capture mode",
+          "The thread that retrieves the grabbed frames from the camera.",
+          GST_TYPE_CAPTURE_MODE_ENUM, PROP_CAPTURE_MODE_DEFAULT,
+          static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+                                   GST_PARAM_MUTABLE_READY)));
+
+  g_object_class_install_property(
+      gobject_class, PROP_ALLOCATOR,
+      g_param_spec_object(
+          "allocator", "Allocator",
+          "Allocator providing the memory the camera grabs into. If not set, "
+          "the allocator proposed by downstream is used, if any.",
+          GST_TYPE_ALLOCATOR,
+          static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+                                   GST_PARAM_MUTABLE_READY)));
+
+  g_object_class_install_property(
+      gobject_class, PROP_MEMORY_PAGES,
+      g_param_spec_enum(
+          "memory-pages", "Memory pages",
+          "The page size backing the system memory grab buffers. Huge pages "
+          "reduce TLB misses when processing large frames. Only supported on "
+          "Linux.",
+          GST_TYPE_MEMORY_PAGES_ENUM, PROP_MEMORY_PAGES_DEFAULT,
+          static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+                                   GST_PARAM_MUTABLE_READY)));
+
+  g_object_class_install_property(
+      gobject_class, PROP_MEMORY_LOCK,
+      g_param_spec_boolean(
+          "memory-lock", "Memory lock",
+          "Pre-fault and lock the system memory grab buffers when they are "
+          "allocated, so they are never paged out or faulted in during "
+          "capture. Only supported on Linux.",
+          PROP_MEMORY_LOCK_DEFAULT,
+          static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+                                   GST_PARAM_MUTABLE_READY)));
+
+  g_object_class_install_property(
+      gobject_class, PROP_NUMA_NODE,
+      g_param_spec_int(
+          "numa-node", "NUMA node",
+          "The NUMA node the system memory grab buffers are bound to. -1 "
+          "uses the node of the first CPU in grab-thread-affinity, or leaves "
+          "the placement to the kernel. Only supported on Linux.",
+          PROP_NUMA_NODE_MIN, PROP_NUMA_NODE_MAX, PROP_NUMA_NODE_DEFAULT,
+          static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+                                   GST_PARAM_MUTABLE_READY)));
+
+  g_object_class_install_property(
+      gobject_class, PROP_GRAB_THREAD_AFFINITY,
+      g_param_spec_string(
+          "grab-thread-affinity", "Grab thread affinity",
+          "List of CPUs the pylon grab loop thread is pinned to, e.g. "
+          "\"0-3,8\". Only used with the grab-thread capture mode and only "
+          "supported on Linux.",
+          PROP_GRAB_THREAD_AFFINITY_DEFAULT,
+          static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+                                   GST_PARAM_MUTABLE_READY)));
+
+  g_object_class_install_property(
+      gobject_class, PROP_GRAB_THREAD_PRIORITY,
+      g_param_spec_int(
+          "grab-thread-priority", "Grab thread priority",
+          "Real-time priority of the pylon grab loop and grab engine threads. "
+          "0 keeps the pylon defaults. Usually requires elevated privileges.",
+          PROP_GRAB_THREAD_PRIORITY_MIN, PROP_GRAB_THREAD_PRIORITY_MAX,
+          PROP_GRAB_THREAD_PRIORITY_DEFAULT,
+          static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+                                   GST_PARAM_MUTABLE_READY)));
+
+  g_object_class_install_property(
+      gobject_class, PROP_STREAMING_THREAD_AFFINITY,
+      g_param_spec_string(
+          "streaming-thread-affinity", "Streaming thread affinity",
+          "List of CPUs the streaming thread is pinned to, e.g. \"0-3,8\". "
+          "Only supported on Linux.",
+          PROP_STREAMING_THREAD_AFFINITY_DEFAULT,
+          static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+                                   GST_PARAM_MUTABLE_READY)));
+
+  g_object_class_install_property(
+      gobject_class, PROP_USE_ARENA,
+      g_param_spec_boolean(
+          "use-arena", "Use arena",
+          "Allocate system memory grab buffers from the arena shared by all "
+          "pylonsrc instances of the process. Can't be combined with "
+          "memory-pages, memory-lock or numa-node.",
+          PROP_USE_ARENA_DEFAULT,
+          static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+                                   GST_PARAM_MUTABLE_READY)));
+
+  g_object_class_install_property(
+      gobject_class, PROP_ARENA_RESERVATION,
+      g_param_spec_uint64(
+          "arena-reservation", "Arena reservation",
+          "Bytes of the arena budget guaranteed to this instance, other "
+          "instances can't allocate them.",
+          0, G_MAXUINT64, PROP_ARENA_RESERVATION_DEFAULT,
+          static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+                                   GST_PARAM_MUTABLE_READY)));
+
+  g_object_class_install_property(
+      gobject_class, PROP_ARENA_BUDGET,
+      g_param_spec_uint64(
+          "arena-budget", "Arena budget",
+          "Maximum number of bytes held by the arena, 0 for no limit. The "
+          "budget is shared by the whole process, setting it on any instance "
+          "changes it for all of them.",
+          0, G_MAXUINT64, PROP_ARENA_BUDGET_DEFAULT,
+          static_cast<GParamFlags>(G_PARAM_READWRITE |
+                                   G_PARAM_STATIC_STRINGS)));
+
+  g_object_class_install_property(
+      gobject_class, PROP_BUFFER_COUNT_MODE,
+      g_param_spec_enum(
+          "buffer-count-mode", "Buffer count mode",
+          "How the number of grab buffers (MaxNumBuffer) is chosen. The "
+          "chosen value is reported in a pylonsrc-buffers element message.",
+          GST_TYPE_BUFFER_COUNT_MODE_ENUM, PROP_BUFFER_COUNT_MODE_DEFAULT,
+          static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+                                   GST_PARAM_MUTABLE_READY)));
+
+  g_object_class_install_property(
+      gobject_class, PROP_TARGET_LATENCY,
+      g_param_spec_uint64(
+          "target-latency", "Target latency",
+          "Time in nanoseconds downstream may hold buffers, used by the auto "
+          "buffer count mode. 0 uses the pipeline latency.",
+          0, G_MAXUINT64, PROP_TARGET_LATENCY_DEFAULT,
+          static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+                                   GST_PARAM_MUTABLE_READY)));
+
+  g_object_class_install_property(
+      gobject_class, PROP_BUFFER_MEMORY_LIMIT,
+      g_param_spec_uint64(
+          "buffer-memory-limit", "Buffer memory limit",
+          "Maximum number of bytes of grab buffers chosen by the auto buffer "
+          "count mode, 0 for no limit.",
+          0, G_MAXUINT64, PROP_BUFFER_MEMORY_LIMIT_DEFAULT,
+          static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+                                   GST_PARAM_MUTABLE_READY)));
+
+  g_object_class_install_property(
+      gobject_class, PROP_TIMESTAMP_MODE,
+      g_param_spec_enum(
+          "timestamp-mode", "Timestamp mode",
+          "The source of the buffer timestamps. The camera clock is mapped "
+          "onto the pipeline clock using latched camera timestamps if the "
+          "camera supports it, otherwise using frame arrival times.",
+          GST_TYPE_TIMESTAMP_MODE_ENUM, PROP_TIMESTAMP_MODE_DEFAULT,
+          static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+                                   GST_PARAM_MUTABLE_READY)));
+
+  g_object_class_install_property(
+      gobject_class, PROP_STATS,
+      g_param_spec_boxed(
+          "stats", "Statistics",
+          "Capture statistics since grabbing started: frames grabbed, "
+          "delivered, dropped by the grab queue, skipped by the grab strategy "
+          "and failed, grab buffers held downstream and the latency from grab "
+          "to push in nanoseconds.",
+          GST_TYPE_STRUCTURE,
+          static_cast<GParamFlags>(G_PARAM_READABLE | G_PARAM_STATIC_STRINGS)));
+
+  g_object_class_install_property(
+      gobject_class, PROP_STATS_INTERVAL,
+      g_param_spec_uint(
+          "stats-interval", "Statistics interval",
+          "Interval in milliseconds at which the statistics are posted as a "
+          "pylonsrc-stats element message, 0 to disable.",
+          0, G_MAXUINT, PROP_STATS_INTERVAL_DEFAULT,
+          static_cast<GParamFlags>(G_PARAM_READWRITE |
+                                   G_PARAM_STATIC_STRINGS)));
 #ifdef NVMM_ENABLED
   g_object_class_install_property(
       gobject_class, PROP_NVSURFACE_LAYOUT,
@@ -332,11 +795,18 @@ static void gst_pylon_src_class_init(GstPylonSrcClass *klass) {
                                    GST_PARAM_MUTABLE_READY)));
 #endif
 
+  /* The properties of each device are documented from a cache filled as
+   * devices get opened, see plugin_init for refreshing it */
   cam_params = gst_pylon_camera_get_string_properties();
   stream_params = gst_pylon_stream_grabber_get_string_properties();
 
-  if (NULL == cam_params) {
-    cam_prolog = "No valid cameras where found connected to the system.";
+  if (NULL == cam_params || NULL == stream_params) {
+    g_free(cam_params);
+    g_free(stream_params);
+    cam_prolog =
+        "No camera has been opened yet. The properties of each camera are "
+        "listed here once it has been used, or after running with "
+        "GST_PYLON_REFRESH_DESCRIPTIONS=1 to inspect all connected cameras.";
     stream_prolog = cam_prolog;
     cam_params = g_strdup("");
     stream_params = g_strdup("");
@@ -377,6 +847,8 @@ static void gst_pylon_src_class_init(GstPylonSrcClass *klass) {
   g_free(cam_params);
   g_free(stream_params);
 
+  element_class->post_message = GST_DEBUG_FUNCPTR(gst_pylon_src_post_message);
+
   base_src_class->get_caps = GST_DEBUG_FUNCPTR(gst_pylon_src_get_caps);
   base_src_class->fixate = GST_DEBUG_FUNCPTR(gst_pylon_src_fixate);
   base_src_class->set_caps = GST_DEBUG_FUNCPTR(gst_pylon_src_set_caps);
@@ -386,6 +858,7 @@ static void gst_pylon_src_class_init(GstPylonSrcClass *klass) {
   base_src_class->stop = GST_DEBUG_FUNCPTR(gst_pylon_src_stop);
   base_src_class->unlock = GST_DEBUG_FUNCPTR(gst_pylon_src_unlock);
   base_src_class->query = GST_DEBUG_FUNCPTR(gst_pylon_src_query);
+  base_src_class->event = GST_DEBUG_FUNCPTR(gst_pylon_src_event);
   push_src_class->create = GST_DEBUG_FUNCPTR(gst_pylon_src_create);
 }
 
@@ -401,9 +874,43 @@ static void gst_pylon_src_init(GstPylonSrc *self) {
   self->pfs_location = PROP_PFS_LOCATION_DEFAULT;
   self->enable_correction = PROP_ENABLE_CORRECTION_DEFAULT;
   self->capture_error = PROP_CAPTURE_ERROR_DEFAULT;
+  self->grab_queue_depth = PROP_GRAB_QUEUE_DEPTH_DEFAULT;
+  self->grab_queue_policy = PROP_GRAB_QUEUE_POLICY_DEFAULT;
+  self->grab_strategy = PROP_GRAB_STRATEGY_DEFAULT;
+  self->output_queue_size = PROP_OUTPUT_QUEUE_SIZE_DEFAULT;
+  self->capture_mode = PROP_CAPTURE_MODE_DEFAULT;
+  self->allocator = PROP_ALLOCATOR_DEFAULT;
+  self->memory_pages = PROP_MEMORY_PAGES_DEFAULT;
+  self->memory_lock = PROP_MEMORY_LOCK_DEFAULT;
+  self->numa_node = PROP_NUMA_NODE_DEFAULT;
+  self->grab_thread_affinity = PROP_GRAB_THREAD_AFFINITY_DEFAULT;
+  self->grab_thread_priority = PROP_GRAB_THREAD_PRIORITY_DEFAULT;
+  self->streaming_thread_affinity = PROP_STREAMING_THREAD_AFFINITY_DEFAULT;
+  self->saved_affinity = NULL;
+  self->use_arena = PROP_USE_ARENA_DEFAULT;
+  self->arena_reservation = PROP_ARENA_RESERVATION_DEFAULT;
+  self->buffer_count_mode = PROP_BUFFER_COUNT_MODE_DEFAULT;
+  self->target_latency = PROP_TARGET_LATENCY_DEFAULT;
+  self->buffer_memory_limit = PROP_BUFFER_MEMORY_LIMIT_DEFAULT;
+  self->pipeline_latency = GST_CLOCK_TIME_NONE;
+  self->sized_latency = GST_CLOCK_TIME_NONE;
+  self->chunk_request = NULL;
+  self->timestamp_mode = PROP_TIMESTAMP_MODE_DEFAULT;
+  self->timestamp_mapper = NULL;
+  self->timestamp_latching = TRUE;
+  self->latch_interval = TIMESTAMP_LATCH_INTERVAL;
+  self->last_latch_time = GST_CLOCK_TIME_NONE;
+  self->last_timestamp = GST_CLOCK_TIME_NONE;
+  self->capture_latency = 0;
+  self->reported_latency = GST_CLOCK_TIME_NONE;
+  self->latency_window_next = 0;
+  self->latency_window_count = 0;
+  self->stats_interval = PROP_STATS_INTERVAL_DEFAULT;
+  self->last_stats_time = 0;
   self->cam = PROP_CAM_DEFAULT;
   self->stream = PROP_STREAM_DEFAULT;
   gst_video_info_init(&self->video_info);
+  self->timestamp_caps = gst_caps_new_empty_simple("timestamp/x-pylon");
 #ifdef NVMM_ENABLED
   self->nvsurface_layout = PROP_NVSURFACE_LAYOUT_DEFAULT;
   self->gpu_id = PROP_GPU_ID_DEFAULT;
@@ -413,6 +920,21 @@ static void gst_pylon_src_init(GstPylonSrc *self) {
   gst_base_src_set_format(base, GST_FORMAT_TIME);
 }
 
+/* Invalid CPU lists are rejected right away instead of when the thread
+ * starts, must be called with the object lock held */
+static void gst_pylon_src_set_affinity(GstPylonSrc *self, gchar **affinity,
+                                       const GValue *value) {
+  const gchar *cpu_list = g_value_get_string(value);
+
+  if (cpu_list && !gst_pylon_thread_affinity_is_valid(cpu_list)) {
+    GST_WARNING_OBJECT(self, "Ignoring invalid CPU list \"%s\"", cpu_list);
+    return;
+  }
+
+  g_free(*affinity);
+  *affinity = g_strdup(cpu_list);
+}
+
 static void gst_pylon_src_set_property(GObject *object, guint property_id,
                                        const GValue *value, GParamSpec *pspec) {
   GstPylonSrc *self = GST_PYLON_SRC(object);
@@ -448,6 +970,74 @@ static void gst_pylon_src_set_property(GObject *object, guint property_id,
       self->capture_error =
           static_cast<GstPylonCaptureErrorEnum>(g_value_get_enum(value));
       break;
+    case PROP_GRAB_QUEUE_DEPTH:
+      self->grab_queue_depth = g_value_get_uint(value);
+      break;
+    case PROP_GRAB_QUEUE_POLICY:
+      self->grab_queue_policy =
+          static_cast<GstPylonQueuePolicyEnum>(g_value_get_enum(value));
+      break;
+    case PROP_GRAB_STRATEGY:
+      self->grab_strategy =
+          static_cast<GstPylonGrabStrategyEnum>(g_value_get_enum(value));
+      break;
+    case PROP_OUTPUT_QUEUE_SIZE:
+      self->output_queue_size = g_value_get_uint(value);
+      break;
+    case PROP_CAPTURE_MODE:
+      self->capture_mode =
+          static_cast<GstPylonCaptureModeEnum>(g_value_get_enum(value));
+      break;
+    case PROP_ALLOCATOR:
+      gst_object_replace(reinterpret_cast<GstObject **>(&self->allocator),
+                         GST_OBJECT_CAST(g_value_get_object(value)));
+      break;
+    case PROP_MEMORY_PAGES:
+      self->memory_pages =
+          static_cast<GstPylonMemoryPagesEnum>(g_value_get_enum(value));
+      break;
+    case PROP_MEMORY_LOCK:
+      self->memory_lock = g_value_get_boolean(value);
+      break;
+    case PROP_NUMA_NODE:
+      self->numa_node = g_value_get_int(value);
+      break;
+    case PROP_GRAB_THREAD_AFFINITY:
+      gst_pylon_src_set_affinity(self, &self->grab_thread_affinity, value);
+      break;
+    case PROP_GRAB_THREAD_PRIORITY:
+      self->grab_thread_priority = g_value_get_int(value);
+      break;
+    case PROP_STREAMING_THREAD_AFFINITY:
+      gst_pylon_src_set_affinity(self, &self->streaming_thread_affinity,
+                                 value);
+      break;
+    case PROP_USE_ARENA:
+      self->use_arena = g_value_get_boolean(value);
+      break;
+    case PROP_ARENA_RESERVATION:
+      self->arena_reservation = g_value_get_uint64(value);
+      break;
+    case PROP_ARENA_BUDGET:
+      gst_pylon_set_arena_budget(g_value_get_uint64(value));
+      break;
+    case PROP_BUFFER_COUNT_MODE:
+      self->buffer_count_mode =
+          static_cast<GstPylonBufferCountModeEnum>(g_value_get_enum(value));
+      break;
+    case PROP_TARGET_LATENCY:
+      self->target_latency = g_value_get_uint64(value);
+      break;
+    case PROP_BUFFER_MEMORY_LIMIT:
+      self->buffer_memory_limit = g_value_get_uint64(value);
+      break;
+    case PROP_TIMESTAMP_MODE:
+      self->timestamp_mode =
+          static_cast<GstPylonTimestampModeEnum>(g_value_get_enum(value));
+      break;
+    case PROP_STATS_INTERVAL:
+      self->stats_interval = g_value_get_uint(value);
+      break;
 #ifdef NVMM_ENABLED
     case PROP_NVSURFACE_LAYOUT:
       self->nvsurface_layout =
@@ -495,6 +1085,73 @@ static void gst_pylon_src_get_property(GObject *object, guint property_id,
     case PROP_CAPTURE_ERROR:
       g_value_set_enum(value, self->capture_error);
       break;
+    case PROP_GRAB_QUEUE_DEPTH:
+      g_value_set_uint(value, self->grab_queue_depth);
+      break;
+    case PROP_GRAB_QUEUE_POLICY:
+      g_value_set_enum(value, self->grab_queue_policy);
+      break;
+    case PROP_GRAB_STRATEGY:
+      g_value_set_enum(value, self->grab_strategy);
+      break;
+    case PROP_OUTPUT_QUEUE_SIZE:
+      g_value_set_uint(value, self->output_queue_size);
+      break;
+    case PROP_CAPTURE_MODE:
+      g_value_set_enum(value, self->capture_mode);
+      break;
+    case PROP_ALLOCATOR:
+      g_value_set_object(value, self->allocator);
+      break;
+    case PROP_MEMORY_PAGES:
+      g_value_set_enum(value, self->memory_pages);
+      break;
+    case PROP_MEMORY_LOCK:
+      g_value_set_boolean(value, self->memory_lock);
+      break;
+    case PROP_NUMA_NODE:
+      g_value_set_int(value, self->numa_node);
+      break;
+    case PROP_GRAB_THREAD_AFFINITY:
+      g_value_set_string(value, self->grab_thread_affinity);
+      break;
+    case PROP_GRAB_THREAD_PRIORITY:
+      g_value_set_int(value, self->grab_thread_priority);
+      break;
+    case PROP_STREAMING_THREAD_AFFINITY:
+      g_value_set_string(value, self->streaming_thread_affinity);
+      break;
+    case PROP_USE_ARENA:
+      g_value_set_boolean(value, self->use_arena);
+      break;
+    case PROP_ARENA_RESERVATION:
+      g_value_set_uint64(value, self->arena_reservation);
+      break;
+    case PROP_ARENA_BUDGET:
+      g_value_set_uint64(value, gst_pylon_get_arena_budget());
+      break;
+    case PROP_BUFFER_COUNT_MODE:
+      g_value_set_enum(value, self->buffer_count_mode);
+      break;
+    case PROP_TARGET_LATENCY:
+      g_value_set_uint64(value, self->target_latency);
+      break;
+    case PROP_BUFFER_MEMORY_LIMIT:
+      g_value_set_uint64(value, self->buffer_memory_limit);
+      break;
+    case PROP_TIMESTAMP_MODE:
+      g_value_set_enum(value, self->timestamp_mode);
+      break;
+    case PROP_STATS:
+      if (self->pylon) {
+        g_value_take_boxed(value, gst_pylon_get_stats(self->pylon));
+      } else {
+        g_value_take_boxed(value, gst_structure_new_empty("pylonsrc-stats"));
+      }
+      break;
+    case PROP_STATS_INTERVAL:
+      g_value_set_uint(value, self->stats_interval);
+      break;
 #ifdef NVMM_ENABLED
     case PROP_NVSURFACE_LAYOUT:
       g_value_set_enum(value, self->nvsurface_layout);
@@ -531,6 +1188,18 @@ static void gst_pylon_src_finalize(GObject *object) {
   g_free(self->user_set);
   self->user_set = NULL;
 
+  g_free(self->grab_thread_affinity);
+  self->grab_thread_affinity = NULL;
+
+  g_free(self->streaming_thread_affinity);
+  self->streaming_thread_affinity = NULL;
+
+  g_free(self->saved_affinity);
+  self->saved_affinity = NULL;
+
+  g_strfreev(self->chunk_request);
+  self->chunk_request = NULL;
+
   if (self->cam) {
     g_object_unref(self->cam);
     self->cam = NULL;
@@ -541,6 +1210,14 @@ static void gst_pylon_src_finalize(GObject *object) {
     self->stream = NULL;
   }
 
+  gst_caps_replace(&self->timestamp_caps, NULL);
+  delete self->timestamp_mapper;
+  self->timestamp_mapper = NULL;
+  if (self->allocator) {
+    gst_object_unref(self->allocator);
+    self->allocator = NULL;
+  }
+
   G_OBJECT_CLASS(gst_pylon_src_parent_class)->finalize(object);
 }
 
@@ -665,10 +1342,27 @@ static gboolean gst_pylon_src_set_caps(GstBaseSrc *src, GstCaps *caps) {
   gchar *error_msg = NULL;
   GError *error = NULL;
   gboolean ret = FALSE;
+  gboolean arena_conflict = FALSE;
   const gchar *action = NULL;
 
   GST_INFO_OBJECT(self, "Setting new caps: %" GST_PTR_FORMAT, caps);
 
+  /* Arena buffers are shared between instances, they can't follow the
+   * memory tuning of a single one */
+  GST_OBJECT_LOCK(self);
+  arena_conflict = self->use_arena &&
+                   (PROP_MEMORY_PAGES_DEFAULT != self->memory_pages ||
+                    self->memory_lock || self->numa_node >= 0);
+  GST_OBJECT_UNLOCK(self);
+
+  if (arena_conflict) {
+    action = "configure";
+    error_msg = g_strdup(
+        "memory-pages, memory-lock and numa-node can't be combined with "
+        "use-arena.");
+    goto error;
+  }
+
   st = gst_caps_get_structure(caps, 0);
   gst_structure_get_int(st, "width", &width);
 
@@ -687,6 +1381,32 @@ static gboolean gst_pylon_src_set_caps(GstBaseSrc *src, GstCaps *caps) {
   } else {
     self->duration = GST_CLOCK_TIME_NONE;
   }
+  gst_pylon_set_grab_queue(self->pylon, self->grab_queue_depth,
+                           self->grab_queue_policy);
+  gst_pylon_set_grab_strategy(self->pylon, self->grab_strategy,
+                              self->output_queue_size);
+  gst_pylon_set_capture_mode(self->pylon, self->capture_mode);
+  gst_pylon_set_memory_config(self->pylon, self->memory_pages,
+                              self->memory_lock, self->numa_node);
+  gst_pylon_set_grab_thread_config(self->pylon, self->grab_thread_affinity,
+                                   self->grab_thread_priority);
+  gst_pylon_set_arena_config(self->pylon, self->use_arena,
+                             self->arena_reservation);
+
+  /* Restart the clock mapping, assuming the camera supports latching until
+   * a latch fails */
+  delete self->timestamp_mapper;
+  self->timestamp_mapper = NULL;
+  if (ENUM_TIMESTAMP_CAMERA_CLOCK == self->timestamp_mode) {
+    self->timestamp_mapper =
+        new GstPylonTimestampMapper(TIMESTAMP_LATCH_WINDOW);
+  }
+  self->timestamp_latching = TRUE;
+  self->latch_interval = TIMESTAMP_LATCH_INTERVAL;
+  self->last_latch_time = GST_CLOCK_TIME_NONE;
+  self->last_timestamp = GST_CLOCK_TIME_NONE;
+  self->latency_window_next = 0;
+  self->latency_window_count = 0;
   GST_OBJECT_UNLOCK(self);
   gst_element_post_message(GST_ELEMENT_CAST(self),
                            gst_message_new_latency(GST_OBJECT_CAST(self)));
@@ -703,12 +1423,7 @@ static gboolean gst_pylon_src_set_caps(GstBaseSrc *src, GstCaps *caps) {
     goto log_error;
   }
 
-  ret = gst_pylon_start(self->pylon, &error);
-  if (FALSE == ret && error) {
-    action = "start";
-    goto log_error;
-  }
-
+  /* Grabbing is started once the allocation is decided */
   ret = gst_video_info_from_caps(&self->video_info, caps);
 
   goto out;
@@ -726,14 +1441,403 @@ out:
   return ret;
 }
 
+/* Find an allocator to grab into, the one set by the application has
+ * precedence over the ones proposed by downstream. Plain system memory is
+ * ignored since the built-in factory already provides page aligned memory */
+static GstAllocator *gst_pylon_src_find_allocator(GstPylonSrc *self,
+                                                  GstQuery *query,
+                                                  GstAllocationParams *params) {
+  GstAllocator *allocator = NULL;
+  GstBufferPool *pool = NULL;
+
+  gst_allocation_params_init(params);
+
+  GST_OBJECT_LOCK(self);
+  if (self->allocator) {
+    allocator = GST_ALLOCATOR(gst_object_ref(self->allocator));
+  }
+  GST_OBJECT_UNLOCK(self);
+
+  if (!allocator && gst_query_get_n_allocation_params(query) > 0) {
+    gst_query_parse_nth_allocation_param(query, 0, &allocator, params);
+  }
+
+  if (!allocator && gst_query_get_n_allocation_pools(query) > 0) {
+    gst_query_parse_nth_allocation_pool(query, 0, &pool, NULL, NULL, NULL);
+    if (pool) {
+      GstStructure *config = gst_buffer_pool_get_config(pool);
+      if (gst_buffer_pool_config_get_allocator(config, &allocator, params) &&
+          allocator) {
+        gst_object_ref(allocator);
+      }
+      gst_structure_free(config);
+      gst_object_unref(pool);
+    }
+  }
+
+  if (allocator &&
+      0 == g_strcmp0(allocator->mem_type, GST_ALLOCATOR_SYSMEM)) {
+    gst_object_unref(allocator);
+    allocator = NULL;
+  }
+
+  return allocator;
+}
+
+/* Latency set on the pipeline by the application, if any */
+static GstClockTime gst_pylon_src_get_pipeline_latency(GstPylonSrc *self) {
+  GstObject *parent = gst_object_get_parent(GST_OBJECT_CAST(self));
+  GstClockTime latency = GST_CLOCK_TIME_NONE;
+
+  while (parent && !GST_IS_PIPELINE(parent)) {
+    GstObject *next = gst_object_get_parent(parent);
+    gst_object_unref(parent);
+    parent = next;
+  }
+
+  if (parent) {
+    latency = gst_pipeline_get_latency(GST_PIPELINE_CAST(parent));
+    gst_object_unref(parent);
+  }
+
+  return latency;
+}
+
+/* Time a buffer is held downstream before it is rendered. The pipeline
+ * latency is only distributed with the LATENCY event when going to PLAYING,
+ * until then the latency configured on the pipeline is used. */
+static GstClockTime gst_pylon_src_get_downstream_latency(GstPylonSrc *self) {
+  GstClockTime latency = GST_CLOCK_TIME_NONE;
+
+  GST_OBJECT_LOCK(self);
+  latency = self->pipeline_latency;
+  GST_OBJECT_UNLOCK(self);
+
+  if (!GST_CLOCK_TIME_IS_VALID(latency)) {
+    latency = gst_pylon_src_get_pipeline_latency(self);
+  }
+
+  return GST_CLOCK_TIME_IS_VALID(latency) ? latency : 0;
+}
+
+/* Number of grab buffers the auto buffer count mode asks for, so every
+ * frame downstream may hold, every frame queued on the way and the frame
+ * being grabbed have a buffer. 0 keeps the stream grabber MaxNumBuffer. */
+static guint gst_pylon_src_get_auto_buffer_count(GstPylonSrc *self,
+                                                 GstClockTime *latency) {
+  GstPylonBufferCountModeEnum mode = ENUM_BUFFER_COUNT_MANUAL;
+  GstClockTime duration = GST_CLOCK_TIME_NONE;
+  guint64 memory_limit = 0;
+  guint64 frame_size = GST_VIDEO_INFO_SIZE(&self->video_info);
+  guint64 num_buffers = 0;
+
+  GST_OBJECT_LOCK(self);
+  mode = self->buffer_count_mode;
+  duration = self->duration;
+  *latency = self->target_latency;
+  memory_limit = self->buffer_memory_limit;
+  GST_OBJECT_UNLOCK(self);
+
+  if (ENUM_BUFFER_COUNT_AUTO != mode) {
+    return 0;
+  }
+
+  if (!GST_CLOCK_TIME_IS_VALID(duration) || 0 == duration) {
+    GST_WARNING_OBJECT(self,
+                       "Framerate is not fixed, keeping the stream grabber "
+                       "MaxNumBuffer");
+    return 0;
+  }
+
+  if (0 == *latency) {
+    *latency = gst_pylon_src_get_downstream_latency(self);
+  }
+
+  /* The queue depth doesn't depend on the current MaxNumBuffer, so
+   * renegotiating doesn't grow the count */
+  num_buffers = gst_util_uint64_scale_ceil(*latency, 1, duration) +
+                gst_pylon_get_queue_depth(self->pylon) + 1;
+
+  if (memory_limit && frame_size && num_buffers * frame_size > memory_limit) {
+    GST_WARNING_OBJECT(self,
+                       "%" G_GUINT64_FORMAT
+                       " buffers are needed for a latency of "
+                       "%" GST_TIME_FORMAT ", limiting to %" G_GUINT64_FORMAT
+                       " bytes",
+                       num_buffers, GST_TIME_ARGS(*latency), memory_limit);
+    num_buffers = memory_limit / frame_size;
+  }
+
+  return CLAMP(num_buffers, 1, G_MAXUINT);
+}
+
+static gboolean gst_pylon_src_decide_buffer_count(GstPylonSrc *self,
+                                                  GError **err) {
+  GstClockTime latency = 0;
+  guint64 frame_size = GST_VIDEO_INFO_SIZE(&self->video_info);
+  guint64 num_buffers = 0;
+
+  num_buffers = gst_pylon_src_get_auto_buffer_count(self, &latency);
+  if (num_buffers) {
+    GST_OBJECT_LOCK(self);
+    self->sized_latency = latency;
+    GST_OBJECT_UNLOCK(self);
+
+    if (!gst_pylon_set_max_num_buffer(self->pylon, num_buffers, err)) {
+      return FALSE;
+    }
+  }
+
+  num_buffers = gst_pylon_get_max_num_buffer(self->pylon);
+
+  GST_INFO_OBJECT(self,
+                  "Using %" G_GUINT64_FORMAT
+                  " grab buffers pinning %" G_GUINT64_FORMAT " bytes",
+                  num_buffers, num_buffers * frame_size);
+  gst_element_post_message(
+      GST_ELEMENT_CAST(self),
+      gst_message_new_element(
+          GST_OBJECT_CAST(self),
+          gst_structure_new("pylonsrc-buffers", "max-num-buffer", G_TYPE_UINT,
+                            static_cast<guint>(num_buffers), "pinned-bytes",
+                            G_TYPE_UINT64, num_buffers * frame_size,
+                            "target-latency", G_TYPE_UINT64, latency, NULL)));
+
+  return TRUE;
+}
+
+static gboolean gst_pylon_src_strv_equal(const gchar *const *a,
+                                         const gchar *const *b) {
+  if (!a || !b) {
+    return a == b;
+  }
+
+  for (; *a && *b; a++, b++) {
+    if (0 != g_strcmp0(*a, *b)) {
+      return FALSE;
+    }
+  }
+
+  return *a == *b;
+}
+
+/* Renegotiating, e.g. after a reconfigure event, keeps grabbing into the
+ * current pool if neither the chunks, the memory nor the number of buffers
+ * change */
+static gboolean gst_pylon_src_keep_buffer_pool(GstPylonSrc *self,
+                                               GstQuery *query, GstCaps *caps,
+                                               const gchar *const *chunks,
+                                               GstAllocator *allocator,
+                                               GstAllocationParams *params) {
+  GstBufferPool *pool = NULL;
+  GstClockTime latency = 0;
+  guint size = GST_VIDEO_INFO_SIZE(&self->video_info);
+  guint num_buffers = 0;
+  gboolean keep = FALSE;
+
+  if (!gst_pylon_is_grabbing(self->pylon) ||
+      !gst_pylon_src_strv_equal(
+          chunks, const_cast<const gchar *const *>(self->chunk_request))) {
+    return FALSE;
+  }
+
+  pool = gst_pylon_get_buffer_pool(self->pylon);
+  if (!pool) {
+    return FALSE;
+  }
+
+  num_buffers = gst_pylon_src_get_auto_buffer_count(self, &latency);
+  if (0 == num_buffers) {
+    num_buffers = gst_pylon_get_max_num_buffer(self->pylon);
+  }
+
+  keep = gst_pylon_buffer_pool_matches(pool, caps, size, num_buffers,
+                                       allocator, params);
+  if (keep) {
+    GST_INFO_OBJECT(self, "Allocation unchanged, keep grabbing");
+    if (gst_query_get_n_allocation_pools(query) > 0) {
+      gst_query_set_nth_allocation_pool(query, 0, pool, size, num_buffers,
+                                        num_buffers);
+    } else {
+      gst_query_add_allocation_pool(query, pool, size, num_buffers,
+                                    num_buffers);
+    }
+  }
+  gst_object_unref(pool);
+
+  return keep;
+}
+
 /* setup allocation query */
 static gboolean gst_pylon_src_decide_allocation(GstBaseSrc *src,
                                                 GstQuery *query) {
   GstPylonSrc *self = GST_PYLON_SRC(src);
+  GstCaps *caps = NULL;
+  GstCapsFeatures *features = NULL;
+  GstBufferPool *pool = NULL;
+  GstStructure *config = NULL;
+  GstAllocator *allocator = NULL;
+  GstAllocationParams params;
+  GError *error = NULL;
+  const gchar *action = NULL;
+  const gchar *mem_type = GST_ALLOCATOR_SYSMEM;
+  GstClockTime capture_latency = 0;
+  gchar **chunks = NULL;
+  gboolean nvmm = FALSE;
+  guint size = 0;
+  guint num_buffers = 0;
 
   GST_LOG_OBJECT(self, "decide_allocation");
 
+  gst_query_parse_allocation(query, &caps, NULL);
+  if (!caps) {
+    GST_WARNING_OBJECT(self, "Allocation query without caps");
+    return FALSE;
+  }
+
+  chunks = gst_pylon_meta_parse_chunk_request(query);
+  if (chunks) {
+    gchar *chunk_list = g_strjoinv(", ", chunks);
+    GST_INFO_OBJECT(self, "Downstream requested chunks: %s", chunk_list);
+    g_free(chunk_list);
+  }
+
+  /* NVMM buffers are copied into surfaces and don't use the pool. DMABuf
+   * grab buffers are exported by pylon itself, so downstream allocators are
+   * only considered for system memory. */
+  features = gst_caps_get_features(caps, 0);
+  gst_allocation_params_init(&params);
+  if (features && gst_caps_features_contains(features, "memory:NVMM")) {
+    nvmm = TRUE;
+  } else if (features &&
+             gst_caps_features_contains(features, "memory:DMABuf")) {
+    mem_type = "dmabuf";
+  } else {
+    allocator = gst_pylon_src_find_allocator(self, query, &params);
+    if (allocator) {
+      mem_type = allocator->mem_type;
+    }
+  }
+
+  if (!nvmm && gst_pylon_src_keep_buffer_pool(
+                   self, query, caps, const_cast<const gchar *const *>(chunks),
+                   allocator, &params)) {
+    goto out;
+  }
+
+  /* Grab buffers are allocated when grabbing starts, which has to wait until
+   * the memory to grab into is known */
+  if (!gst_pylon_stop(self->pylon, &error)) {
+    action = "stop";
+    goto log_error;
+  }
+
+  /* Chunks change the payload size, so they go before the buffer count */
+  if (!gst_pylon_set_chunk_selection(
+          self->pylon, const_cast<const gchar *const *>(chunks), &error)) {
+    action = "configure";
+    goto log_error;
+  }
+  g_strfreev(self->chunk_request);
+  self->chunk_request = chunks;
+  chunks = NULL;
+
+  if (!gst_pylon_src_decide_buffer_count(self, &error)) {
+    action = "configure";
+    goto log_error;
+  }
+
+  if (nvmm) {
+    if (!gst_pylon_set_buffer_pool(self->pylon, NULL, &error)) {
+      action = "configure";
+      goto log_error;
+    }
+    goto start;
+  }
+
+  /* Every pylon grab buffer maps to exactly one pool buffer */
+  size = GST_VIDEO_INFO_SIZE(&self->video_info);
+  num_buffers = gst_pylon_get_max_num_buffer(self->pylon);
+
+  pool = gst_pylon_buffer_pool_new();
+  config = gst_buffer_pool_get_config(pool);
+  gst_buffer_pool_config_set_params(config, caps, size, num_buffers,
+                                    num_buffers);
+  gst_buffer_pool_config_set_allocator(config, allocator, &params);
+  gst_buffer_pool_config_add_option(config, GST_BUFFER_POOL_OPTION_VIDEO_META);
+
+  if (!gst_buffer_pool_set_config(pool, config)) {
+    GST_ELEMENT_ERROR(self, RESOURCE, SETTINGS,
+                      ("Failed to configure buffer pool."), (NULL));
+    gst_object_unref(pool);
+    if (allocator) {
+      gst_object_unref(allocator);
+    }
+    return FALSE;
+  }
+
+  /* The grab buffers come from the allocator of the pool config */
+  if (!gst_pylon_set_buffer_pool(self->pylon, pool, &error)) {
+    gst_object_unref(pool);
+    action = "configure";
+    goto log_error;
+  }
+
+  if (gst_query_get_n_allocation_pools(query) > 0) {
+    gst_query_set_nth_allocation_pool(query, 0, pool, size, num_buffers,
+                                      num_buffers);
+  } else {
+    gst_query_add_allocation_pool(query, pool, size, num_buffers,
+                                  num_buffers);
+  }
+
+  GST_INFO_OBJECT(self,
+                  "Using pylon buffer pool with %u buffers of %u bytes from "
+                  "%s memory",
+                  num_buffers, size, mem_type);
+
+  gst_object_unref(pool);
+
+start:
+  capture_latency = GST_CLOCK_TIME_NONE;
+  if (!gst_pylon_get_capture_latency(self->pylon, &capture_latency, &error)) {
+    GST_WARNING_OBJECT(self, "Failed to query capture latency: %s",
+                       error->message);
+    g_clear_error(&error);
+  }
+  GST_OBJECT_LOCK(self);
+  /* Not being able to estimate the latency is no reason to not stream,
+   * a frame takes at least its frame duration to arrive */
+  if (!GST_CLOCK_TIME_IS_VALID(capture_latency)) {
+    capture_latency =
+        GST_CLOCK_TIME_IS_VALID(self->duration) ? self->duration : 0;
+  }
+  self->capture_latency = capture_latency;
+  GST_OBJECT_UNLOCK(self);
+
+  if (!gst_pylon_start(self->pylon, &error)) {
+    action = "start";
+    goto log_error;
+  }
+
+out:
+  g_strfreev(chunks);
+  if (allocator) {
+    gst_object_unref(allocator);
+  }
+
   return TRUE;
+
+log_error:
+  GST_ELEMENT_ERROR(self, LIBRARY, FAILED, ("Failed to %s camera.", action),
+                    ("%s", error ? error->message : "unknown error"));
+  g_clear_error(&error);
+  g_strfreev(chunks);
+  if (allocator) {
+    gst_object_unref(allocator);
+  }
+
+  return FALSE;
 }
 
 /* start and stop processing, ideal for opening/closing the resource */
@@ -836,12 +1940,20 @@ out:
 
 static gboolean gst_pylon_src_stop(GstBaseSrc *src) {
   GstPylonSrc *self = GST_PYLON_SRC(src);
+  GstPylon *pylon = NULL;
   GError *error = NULL;
   gboolean ret = TRUE;
 
   GST_INFO_OBJECT(self, "Stopping camera device");
 
-  ret = gst_pylon_stop(self->pylon, &error);
+  /* Property readers such as stats check the camera with the object lock
+   * held */
+  GST_OBJECT_LOCK(self);
+  pylon = self->pylon;
+  self->pylon = NULL;
+  GST_OBJECT_UNLOCK(self);
+
+  ret = gst_pylon_stop(pylon, &error);
 
   if (ret == FALSE && error) {
     GST_ELEMENT_ERROR(self, LIBRARY, FAILED, ("Failed to close camera."),
@@ -849,8 +1961,7 @@ static gboolean gst_pylon_src_stop(GstBaseSrc *src) {
     g_error_free(error);
   }
 
-  gst_pylon_free(self->pylon);
-  self->pylon = NULL;
+  gst_pylon_free(pylon);
 
   Pylon::PylonTerminate();
 
@@ -878,14 +1989,28 @@ static gboolean gst_pylon_src_query(GstBaseSrc *src, GstQuery *query) {
     case GST_QUERY_LATENCY: {
       GstClockTime min_latency;
       GstClockTime max_latency;
-
-      if (GST_CLOCK_TIME_NONE == self->duration) {
+      GstClockTime duration;
+
+      GST_OBJECT_LOCK(self);
+      duration = self->duration;
+      min_latency = gst_pylon_src_get_min_latency(self);
+      /* Without a duration no latency is reported, so there is nothing
+       * for a measured latency to drift from */
+      self->reported_latency =
+          GST_CLOCK_TIME_NONE == duration ? GST_CLOCK_TIME_NONE : min_latency;
+      GST_OBJECT_UNLOCK(self);
+
+      if (GST_CLOCK_TIME_NONE == duration) {
         GST_WARNING_OBJECT(
             src, "Can't report latency since framerate is not fixated yet");
         min_latency = 0;
         max_latency = GST_CLOCK_TIME_NONE;
       } else {
-        max_latency = min_latency = self->duration;
+        /* A frame may wait behind every frame queued in the instant camera
+         * and in the grab queue before it is pushed */
+        max_latency =
+            min_latency +
+            duration * gst_pylon_get_max_queued_frames(self->pylon);
       }
 
       GST_DEBUG_OBJECT(
@@ -905,16 +2030,248 @@ static gboolean gst_pylon_src_query(GstBaseSrc *src, GstQuery *query) {
   return res;
 }
 
+/* The pipeline latency decides how many buffers downstream may hold,
+ * renegotiate if it differs from the one the grab buffers were sized for */
+static gboolean gst_pylon_src_event(GstBaseSrc *src, GstEvent *event) {
+  GstPylonSrc *self = GST_PYLON_SRC(src);
+
+  if (GST_EVENT_LATENCY == GST_EVENT_TYPE(event)) {
+    GstClockTime latency = GST_CLOCK_TIME_NONE;
+    gboolean resize = FALSE;
+
+    gst_event_parse_latency(event, &latency);
+
+    GST_OBJECT_LOCK(self);
+    self->pipeline_latency = latency;
+    resize = ENUM_BUFFER_COUNT_AUTO == self->buffer_count_mode &&
+             0 == self->target_latency &&
+             GST_CLOCK_TIME_IS_VALID(self->sized_latency) &&
+             latency != self->sized_latency;
+    GST_OBJECT_UNLOCK(self);
+
+    if (resize) {
+      GST_INFO_OBJECT(self,
+                      "Pipeline latency is %" GST_TIME_FORMAT
+                      ", resizing the grab buffers",
+                      GST_TIME_ARGS(latency));
+      gst_pad_mark_reconfigure(GST_BASE_SRC_PAD(self));
+    }
+  }
+
+  return GST_BASE_SRC_CLASS(gst_pylon_src_parent_class)->event(src, event);
+}
+
+/* Buffers timestamped with the pipeline clock are one frame late at most,
+ * camera timestamps are as late as the exposure, readout and transfer or
+ * the largest measured delay. Must be called with the object lock held. */
+static GstClockTime gst_pylon_src_get_min_latency(GstPylonSrc *self) {
+  GstClockTime latency = self->capture_latency;
+
+  if (ENUM_TIMESTAMP_CAMERA_CLOCK != self->timestamp_mode) {
+    return self->duration;
+  }
+
+  for (guint i = 0; i < self->latency_window_count; i++) {
+    latency = MAX(latency, self->latency_window[i]);
+  }
+
+  return latency;
+}
+
+/* Track the delay between exposure start and push, and ask the pipeline to
+ * reconfigure its latency if it drifted away from the reported one */
+static void gst_pylon_src_update_latency(GstPylonSrc *self,
+                                         GstClockTime delay) {
+  GstClockTime latency = GST_CLOCK_TIME_NONE;
+  GstClockTime reported = GST_CLOCK_TIME_NONE;
+  GstClockTime threshold = 0;
+  gboolean window_full = FALSE;
+
+  GST_OBJECT_LOCK(self);
+  self->latency_window[self->latency_window_next] = delay;
+  self->latency_window_next = (self->latency_window_next + 1) % LATENCY_WINDOW;
+  self->latency_window_count =
+      MIN(self->latency_window_count + 1, LATENCY_WINDOW);
+  window_full = LATENCY_WINDOW == self->latency_window_count;
+
+  latency = gst_pylon_src_get_min_latency(self);
+  reported = self->reported_latency;
+  GST_OBJECT_UNLOCK(self);
+
+  if (!GST_CLOCK_TIME_IS_VALID(reported) || !window_full) {
+    return;
+  }
+
+  threshold = MAX(LATENCY_DRIFT_MIN, reported / LATENCY_DRIFT_DIVISOR);
+  if (latency > reported + threshold || latency + threshold < reported) {
+    GST_INFO_OBJECT(self,
+                    "Latency drifted from %" GST_TIME_FORMAT
+                    " to %" GST_TIME_FORMAT,
+                    GST_TIME_ARGS(reported), GST_TIME_ARGS(latency));
+    GST_OBJECT_LOCK(self);
+    self->reported_latency = latency;
+    GST_OBJECT_UNLOCK(self);
+    gst_element_post_message(GST_ELEMENT_CAST(self),
+                             gst_message_new_latency(GST_OBJECT_CAST(self)));
+  }
+}
+
+/* Map the camera timestamp of a frame onto the pipeline clock. Until
+ * enough samples are collected the arrival time is used. If latching fails
+ * the arrival times are mapped instead, until a retry succeeds. */
+static GstClockTime gst_pylon_src_map_camera_timestamp(GstPylonSrc *self,
+                                                       GstClock *clock,
+                                                       guint64 ticks,
+                                                       GstClockTime arrival) {
+  GstPylonTimestampMapper *mapper = self->timestamp_mapper;
+  GstClockTime timestamp = GST_CLOCK_TIME_NONE;
+  gboolean mapped = mapper->Map(ticks, timestamp);
+
+  if ((self->timestamp_latching && !mapped) ||
+      !GST_CLOCK_TIME_IS_VALID(self->last_latch_time) ||
+      arrival - self->last_latch_time >= self->latch_interval) {
+    GError *error = NULL;
+    guint64 latched = 0;
+
+    self->last_latch_time = arrival;
+
+    /* The latch happened somewhere during the round trip */
+    GstClockTime before = gst_clock_get_time(clock);
+    if (gst_pylon_latch_timestamp(self->pylon, &latched, &error)) {
+      GstClockTime after = gst_clock_get_time(clock);
+      if (!self->timestamp_latching) {
+        GST_INFO_OBJECT(self, "Mapping camera timestamps by latching");
+        self->timestamp_latching = TRUE;
+        delete self->timestamp_mapper;
+        mapper = self->timestamp_mapper =
+            new GstPylonTimestampMapper(TIMESTAMP_LATCH_WINDOW);
+      }
+      self->latch_interval = TIMESTAMP_LATCH_INTERVAL;
+      mapper->AddSample(latched, before + (after - before) / 2);
+    } else {
+      self->latch_interval =
+          MIN(2 * self->latch_interval, TIMESTAMP_LATCH_RETRY_MAX);
+      GST_INFO_OBJECT(self,
+                      "Failed to latch camera timestamp, retrying in "
+                      "%" GST_TIME_FORMAT ": %s",
+                      GST_TIME_ARGS(self->latch_interval), error->message);
+      g_error_free(error);
+      /* An established fit survives a few failed latches */
+      if (self->timestamp_latching &&
+          (!mapped || TIMESTAMP_LATCH_RETRY_MAX == self->latch_interval)) {
+        GST_INFO_OBJECT(self, "Mapping camera timestamps by arrival time");
+        self->timestamp_latching = FALSE;
+        delete self->timestamp_mapper;
+        mapper = self->timestamp_mapper =
+            new GstPylonTimestampMapper(TIMESTAMP_ARRIVAL_WINDOW);
+      }
+    }
+  }
+
+  if (!self->timestamp_latching) {
+    mapper->AddSample(ticks, arrival);
+  }
+
+  if (!mapper->Map(ticks, timestamp)) {
+    return arrival;
+  }
+
+  /* A frame can't be exposed after it arrived, and the fit must not move
+   * timestamps backwards while it settles */
+  timestamp = MIN(timestamp, arrival);
+  if (GST_CLOCK_TIME_IS_VALID(self->last_timestamp)) {
+    timestamp = MAX(timestamp, self->last_timestamp);
+  }
+  self->last_timestamp = timestamp;
+
+  gst_pylon_src_update_latency(self, arrival - timestamp);
+
+  return timestamp;
+}
+
+/* Pin the streaming thread while the pad task runs on it. Task threads
+ * come from a pool and may run other tasks later, so the previous affinity
+ * is restored when the task leaves the thread. */
+static void gst_pylon_src_enter_streaming_thread(GstPylonSrc *self) {
+  gchar *cpu_list = NULL;
+  GError *error = NULL;
+
+  GST_OBJECT_LOCK(self);
+  cpu_list = g_strdup(self->streaming_thread_affinity);
+  GST_OBJECT_UNLOCK(self);
+
+  if (!cpu_list) {
+    return;
+  }
+
+  self->saved_affinity = gst_pylon_thread_get_affinity(&error);
+  if (error) {
+    GST_DEBUG_OBJECT(self, "Streaming thread affinity won't be restored: %s",
+                     error->message);
+    g_clear_error(&error);
+  }
+
+  if (!gst_pylon_thread_set_affinity(cpu_list, &error)) {
+    GST_ELEMENT_WARNING(self, RESOURCE, SETTINGS,
+                        ("Failed to pin streaming thread."),
+                        ("%s", error->message));
+    g_clear_error(&error);
+    g_free(self->saved_affinity);
+    self->saved_affinity = NULL;
+  }
+
+  g_free(cpu_list);
+}
+
+static void gst_pylon_src_leave_streaming_thread(GstPylonSrc *self) {
+  GError *error = NULL;
+
+  if (!self->saved_affinity) {
+    return;
+  }
+
+  if (!gst_pylon_thread_set_affinity(self->saved_affinity, &error)) {
+    GST_WARNING_OBJECT(self, "Failed to restore streaming thread affinity: %s",
+                       error->message);
+    g_clear_error(&error);
+  }
+
+  g_free(self->saved_affinity);
+  self->saved_affinity = NULL;
+}
+
+/* The enter and leave callbacks of the pad task post these stream status
+ * messages from the streaming thread itself */
+static gboolean gst_pylon_src_post_message(GstElement *element,
+                                           GstMessage *message) {
+  GstPylonSrc *self = GST_PYLON_SRC(element);
+  GstStreamStatusType type = GST_STREAM_STATUS_TYPE_CREATE;
+  GstElement *owner = NULL;
+
+  if (GST_MESSAGE_STREAM_STATUS == GST_MESSAGE_TYPE(message)) {
+    gst_message_parse_stream_status(message, &type, &owner);
+    if (owner == element && GST_STREAM_STATUS_TYPE_ENTER == type) {
+      gst_pylon_src_enter_streaming_thread(self);
+    } else if (owner == element && GST_STREAM_STATUS_TYPE_LEAVE == type) {
+      gst_pylon_src_leave_streaming_thread(self);
+    }
+  }
+
+  return GST_ELEMENT_CLASS(gst_pylon_src_parent_class)
+      ->post_message(element, message);
+}
+
 /* add time metadata to buffer */
 static void gst_plyon_src_add_metadata(GstPylonSrc *self, GstBuffer *buf) {
   GstClock *clock = NULL;
   GstClockTime abs_time = GST_CLOCK_TIME_NONE;
   GstClockTime base_time = GST_CLOCK_TIME_NONE;
   GstClockTime timestamp = GST_CLOCK_TIME_NONE;
-  GstCaps *ref = NULL;
   guint64 offset = G_GUINT64_CONSTANT(0);
   GstVideoFormat format = GST_VIDEO_FORMAT_UNKNOWN;
   GstPylonMeta *pylon_meta = NULL;
+  GstReferenceTimestampMeta *ts_meta = NULL;
+  GstVideoMeta *video_meta = NULL;
   guint width = 0;
   guint height = 0;
   guint n_planes = 0;
@@ -943,6 +2300,10 @@ static void gst_plyon_src_add_metadata(GstPylonSrc *self, GstBuffer *buf) {
   /* sample pipeline clock */
   if (clock) {
     abs_time = gst_clock_get_time(clock);
+    if (self->timestamp_mapper) {
+      abs_time = gst_pylon_src_map_camera_timestamp(
+          self, clock, pylon_meta->timestamp, abs_time);
+    }
     gst_object_unref(clock);
   } else {
     abs_time = GST_CLOCK_TIME_NONE;
@@ -955,11 +2316,16 @@ static void gst_plyon_src_add_metadata(GstPylonSrc *self, GstBuffer *buf) {
   GST_BUFFER_OFFSET(buf) = offset;
   GST_BUFFER_OFFSET_END(buf) = offset + 1;
 
-  /* add pylon timestamp as reference timestamp meta */
-  ref = gst_caps_from_string("timestamp/x-pylon");
-  gst_buffer_add_reference_timestamp_meta(buf, ref, pylon_meta->timestamp,
-                                          GST_CLOCK_TIME_NONE);
-  gst_caps_unref(ref);
+  /* add pylon timestamp as reference timestamp meta, pooled buffers keep
+   * theirs from the previous frame */
+  ts_meta = gst_buffer_get_reference_timestamp_meta(buf, self->timestamp_caps);
+  if (ts_meta) {
+    ts_meta->timestamp = pylon_meta->timestamp;
+  } else {
+    ts_meta = gst_buffer_add_reference_timestamp_meta(
+        buf, self->timestamp_caps, pylon_meta->timestamp, GST_CLOCK_TIME_NONE);
+    GST_META_FLAG_SET(ts_meta, GST_META_FLAG_POOLED);
+  }
 
   /* add video meta data */
   format = GST_VIDEO_INFO_FORMAT(&self->video_info);
@@ -972,9 +2338,23 @@ static void gst_plyon_src_add_metadata(GstPylonSrc *self, GstBuffer *buf) {
     stride[p] = pylon_meta->stride;
   }
 
-  gst_buffer_add_video_meta_full(buf, GST_VIDEO_FRAME_FLAG_NONE, format, width,
-                                 height, n_planes, self->video_info.offset,
-                                 stride);
+  video_meta = gst_buffer_get_video_meta(buf);
+  if (video_meta) {
+    video_meta->flags = GST_VIDEO_FRAME_FLAG_NONE;
+    video_meta->format = format;
+    video_meta->width = width;
+    video_meta->height = height;
+    video_meta->n_planes = n_planes;
+    for (guint p = 0; p < n_planes; p++) {
+      video_meta->offset[p] = self->video_info.offset[p];
+      video_meta->stride[p] = stride[p];
+    }
+  } else {
+    video_meta = gst_buffer_add_video_meta_full(
+        buf, GST_VIDEO_FRAME_FLAG_NONE, format, width, height, n_planes,
+        self->video_info.offset, stride);
+    GST_META_FLAG_SET(video_meta, GST_META_FLAG_POOLED);
+  }
 }
 
 /* ask the subclass to create a buffer with offset and size, the default
@@ -985,9 +2365,12 @@ static GstFlowReturn gst_pylon_src_create(GstPushSrc *src, GstBuffer **buf) {
   gboolean pylon_ret = TRUE;
   GstFlowReturn ret = GST_FLOW_OK;
   gint capture_error = -1;
+  guint stats_interval = 0;
+  gint64 now = 0;
 
   GST_OBJECT_LOCK(self);
   capture_error = self->capture_error;
+  stats_interval = self->stats_interval;
   GST_OBJECT_UNLOCK(self);
 
   pylon_ret = gst_pylon_capture(
@@ -1013,6 +2396,17 @@ static GstFlowReturn gst_pylon_src_create(GstPushSrc *src, GstBuffer **buf) {
 
   GST_LOG_OBJECT(self, "Created buffer %" GST_PTR_FORMAT, *buf);
 
+  if (stats_interval) {
+    now = g_get_monotonic_time();
+    if (now - self->last_stats_time >=
+        static_cast<gint64>(stats_interval) * G_TIME_SPAN_MILLISECOND) {
+      GstStructure *st = gst_pylon_get_stats(self->pylon);
+      gst_element_post_message(GST_ELEMENT(self),
+                               gst_message_new_element(GST_OBJECT(self), st));
+      self->last_stats_time = now;
+    }
+  }
+
 done:
   return ret;
 }
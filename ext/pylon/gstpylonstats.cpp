@@ -0,0 +1,122 @@
+/* Copyright (C) 2024 Basler AG
+ *
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *     1. Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *     2. Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *     3. Neither the name of the copyright holder nor the names of
+ *        its contributors may be used to endorse or promote products
+ *        derived from this software without specific prior written
+ *        permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "gstpylonstats.h"
+
+GstPylonStats::GstPylonStats() { this->Reset(); }
+
+void GstPylonStats::Reset() {
+  this->delivered.store(0);
+  this->skipped.store(0);
+  this->failed.store(0);
+  this->latency_sum.store(0);
+  this->latency_min.store(G_MAXUINT64);
+  this->latency_max.store(0);
+  for (auto &bucket : this->latency_buckets) {
+    bucket.store(0);
+  }
+}
+
+void GstPylonStats::AddDelivered(guint64 skipped, GstClockTime latency) {
+  guint64 current = 0;
+  guint64 latency_us = latency / GST_USECOND;
+  guint bucket = 0;
+
+  this->delivered.fetch_add(1, std::memory_order_relaxed);
+  this->skipped.fetch_add(skipped, std::memory_order_relaxed);
+  this->latency_sum.fetch_add(latency, std::memory_order_relaxed);
+
+  current = this->latency_min.load(std::memory_order_relaxed);
+  while (latency < current &&
+         !this->latency_min.compare_exchange_weak(current, latency,
+                                                  std::memory_order_relaxed)) {
+  }
+
+  current = this->latency_max.load(std::memory_order_relaxed);
+  while (latency > current &&
+         !this->latency_max.compare_exchange_weak(current, latency,
+                                                  std::memory_order_relaxed)) {
+  }
+
+  /* Bucket n holds latencies below 2^n us */
+  while (latency_us && bucket < LATENCY_BUCKETS - 1) {
+    latency_us >>= 1;
+    bucket++;
+  }
+  this->latency_buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+}
+
+void GstPylonStats::AddFailed() {
+  this->failed.fetch_add(1, std::memory_order_relaxed);
+}
+
+/* Upper bound of the bucket containing the percentile */
+GstClockTime GstPylonStats::GetLatencyPercentile(guint64 count,
+                                                 guint percentile) {
+  const guint64 rank = (count * percentile + 99) / 100;
+  guint64 seen = 0;
+
+  for (guint i = 0; i < LATENCY_BUCKETS; i++) {
+    seen += this->latency_buckets[i].load(std::memory_order_relaxed);
+    if (seen >= rank) {
+      return (G_GUINT64_CONSTANT(1) << i) * GST_USECOND;
+    }
+  }
+
+  return this->latency_max.load(std::memory_order_relaxed);
+}
+
+void GstPylonStats::Fill(GstStructure *st) {
+  const guint64 delivered = this->delivered.load(std::memory_order_relaxed);
+  GstClockTime latency_min = 0;
+  GstClockTime latency_mean = 0;
+  GstClockTime latency_p50 = 0;
+  GstClockTime latency_p99 = 0;
+
+  if (delivered) {
+    latency_min = this->latency_min.load(std::memory_order_relaxed);
+    latency_mean =
+        this->latency_sum.load(std::memory_order_relaxed) / delivered;
+    latency_p50 = this->GetLatencyPercentile(delivered, 50);
+    latency_p99 = this->GetLatencyPercentile(delivered, 99);
+  }
+
+  gst_structure_set(
+      st, "frames-delivered", G_TYPE_UINT64, delivered, "frames-skipped",
+      G_TYPE_UINT64, this->skipped.load(std::memory_order_relaxed),
+      "frames-failed", G_TYPE_UINT64,
+      this->failed.load(std::memory_order_relaxed), "latency-min",
+      G_TYPE_UINT64, latency_min, "latency-mean", G_TYPE_UINT64, latency_mean,
+      "latency-p50", G_TYPE_UINT64, latency_p50, "latency-p99", G_TYPE_UINT64,
+      latency_p99, "latency-max", G_TYPE_UINT64,
+      this->latency_max.load(std::memory_order_relaxed), NULL);
+}
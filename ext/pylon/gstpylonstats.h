@@ -0,0 +1,68 @@
+/* Copyright (C) 2024 Basler AG
+ *
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *     1. Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *     2. Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *     3. Neither the name of the copyright holder nor the names of
+ *        its contributors may be used to endorse or promote products
+ *        derived from this software without specific prior written
+ *        permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef GST_PYLON_STATS_H
+#define GST_PYLON_STATS_H
+
+#include <gst/gst.h>
+
+#include <atomic>
+
+/* Streaming counters updated by the grab and streaming threads without
+ * locking, read by any thread. The grab to push latency is kept as a
+ * histogram with power of two buckets in microseconds. */
+class GstPylonStats {
+ public:
+  GstPylonStats();
+
+  void Reset();
+  void AddDelivered(guint64 skipped, GstClockTime latency);
+  void AddFailed();
+
+  /* Adds the counters and latency distribution to a stats structure */
+  void Fill(GstStructure *st);
+
+ private:
+  static constexpr guint LATENCY_BUCKETS = 24;
+
+  GstClockTime GetLatencyPercentile(guint64 count, guint percentile);
+
+  std::atomic<guint64> delivered;
+  std::atomic<guint64> skipped;
+  std::atomic<guint64> failed;
+  std::atomic<guint64> latency_sum;
+  std::atomic<guint64> latency_min;
+  std::atomic<guint64> latency_max;
+  std::atomic<guint64> latency_buckets[LATENCY_BUCKETS];
+};
+
+#endif
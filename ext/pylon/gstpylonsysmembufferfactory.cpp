@@ -30,6 +30,7 @@
  * OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include "gst/pylon/gstpylondebug.h"
 #include "gstpylonsysmembufferfactory.h"
 
 #if defined(__GNUC__)
@@ -37,11 +38,146 @@
 #include <unistd.h>
 #endif
 
+#if defined(__linux__)
+#include <linux/mempolicy.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+/* Explicit huge page buffers are mapped instead of allocated from the heap.
+ * Buffer sizes are page aligned, so the lowest bit of the size stored as
+ * buffer context is free to mark them. */
+constexpr intptr_t MAPPED_BUFFER_FLAG = 1;
+constexpr size_t DEFAULT_HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+static size_t gst_pylon_get_huge_page_size() {
+  std::ifstream meminfo("/proc/meminfo");
+  std::string line;
+
+  while (std::getline(meminfo, line)) {
+    size_t size_kb = 0;
+    if (1 == sscanf(line.c_str(), "Hugepagesize: %zu kB", &size_kb)) {
+      return size_kb * 1024;
+    }
+  }
+
+  return DEFAULT_HUGE_PAGE_SIZE;
+}
+#endif
+
+GstPylonSysMemBufferFactory::GstPylonSysMemBufferFactory(
+    GstPylonMemoryPagesEnum pages, bool lock, gint numa_node)
+    : pages(pages), lock(lock), numa_node(numa_node) {
+#if defined(__linux__)
+  this->huge_page_size = ENUM_PAGES_NORMAL == pages
+                             ? DEFAULT_HUGE_PAGE_SIZE
+                             : gst_pylon_get_huge_page_size();
+#else
+  if (ENUM_PAGES_NORMAL != pages || lock || numa_node >= 0) {
+    GST_WARNING("Huge pages, locking and NUMA binding are only supported on "
+                "Linux, using plain buffers");
+  }
+#endif
+}
+
+#if defined(__linux__)
+void *GstPylonSysMemBufferFactory::AllocateHugePages(size_t size) {
+  void *buffer = mmap(NULL, size, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+
+  if (MAP_FAILED == buffer) {
+    GST_WARNING("Unable to map %" G_GSIZE_FORMAT
+                " bytes of huge pages (%s), falling back to transparent huge "
+                "pages. Check vm.nr_hugepages",
+                size, g_strerror(errno));
+    return nullptr;
+  }
+
+  return buffer;
+}
+
+void GstPylonSysMemBufferFactory::BindToNode(void *buffer, size_t size) {
+  const size_t bits = 8 * sizeof(unsigned long);
+  const unsigned int node = this->numa_node;
+
+  /* Without an explicit node the kernel places the pages where they are
+   * first touched */
+  if (this->numa_node < 0) {
+    return;
+  }
+
+  std::vector<unsigned long> mask(node / bits + 1, 0);
+  mask[node / bits] |= 1UL << (node % bits);
+
+  if (0 != syscall(SYS_mbind, buffer, size, MPOL_BIND, mask.data(),
+                   mask.size() * bits + 1, MPOL_MF_MOVE)) {
+    GST_WARNING("Unable to bind grab buffer to NUMA node %u: %s", node,
+                g_strerror(errno));
+  }
+}
+
+void GstPylonSysMemBufferFactory::Prefault(void *buffer, size_t size) {
+  /* Locking faults in all pages, so the first DMA doesn't have to */
+  if (0 == mlock(buffer, size)) {
+    return;
+  }
+
+  GST_WARNING("Unable to lock grab buffer (%s), only pre-faulting it. Check "
+              "RLIMIT_MEMLOCK",
+              g_strerror(errno));
+  memset(buffer, 0, size);
+}
+#endif
+
 void GstPylonSysMemBufferFactory::AllocateBuffer(
     size_t buffer_size, void **p_created_buffer,
-    intptr_t & /*buffer_context*/) {
+    intptr_t &buffer_context) {
 
-#if defined(__GNUC__)
+#if defined(__linux__)
+  const size_t page_size = getpagesize();
+  size_t aligned_buffer_size = 0;
+  void *buffer = nullptr;
+
+  *p_created_buffer = nullptr;
+  buffer_context = 0;
+
+  if (ENUM_PAGES_HUGE == this->pages) {
+    aligned_buffer_size = RoundUp(buffer_size, this->huge_page_size);
+    buffer = this->AllocateHugePages(aligned_buffer_size);
+    if (buffer) {
+      buffer_context |= MAPPED_BUFFER_FLAG;
+    }
+  }
+
+  /* Heap buffers only need page alignment, transparent huge pages back
+   * the aligned parts of the buffer. Aligning to the huge page size could
+   * waste up to a gigabyte per buffer. */
+  if (!buffer) {
+    aligned_buffer_size = RoundUp(buffer_size, page_size);
+    if (posix_memalign(&buffer, page_size, aligned_buffer_size)) {
+      return;
+    }
+    if (ENUM_PAGES_NORMAL != this->pages &&
+        0 != madvise(buffer, aligned_buffer_size, MADV_HUGEPAGE)) {
+      GST_WARNING("Transparent huge pages are not available: %s",
+                  g_strerror(errno));
+    }
+  }
+
+  this->BindToNode(buffer, aligned_buffer_size);
+  if (this->lock) {
+    this->Prefault(buffer, aligned_buffer_size);
+  }
+
+  *p_created_buffer = buffer;
+  buffer_context |= aligned_buffer_size;
+#elif defined(__GNUC__)
   const size_t PAGE_SIZE = getpagesize();
   const size_t aligned_buffer_size = RoundUp(buffer_size, PAGE_SIZE);
   int ret = posix_memalign(p_created_buffer, PAGE_SIZE, aligned_buffer_size);
@@ -53,7 +189,23 @@ void GstPylonSysMemBufferFactory::AllocateBuffer(
 }
 
 void GstPylonSysMemBufferFactory::FreeBuffer(void *p_created_buffer,
-                                             intptr_t /* buffer_context */) {
+                                             intptr_t buffer_context) {
+#if defined(__linux__)
+  const size_t size = buffer_context & ~MAPPED_BUFFER_FLAG;
+
+  if (!p_created_buffer) {
+    return;
+  }
+
+  if (this->lock) {
+    munlock(p_created_buffer, size);
+  }
+
+  if (buffer_context & MAPPED_BUFFER_FLAG) {
+    munmap(p_created_buffer, size);
+    return;
+  }
+#endif
   free(p_created_buffer);
 }
 
@@ -35,11 +35,15 @@
 
 #include <gst/gst.h>
 #include <gst/pylon/gstpylonincludes.h>
+#include <gstpylon.h>
 #include <gstpylonbufferfactory.h>
 
 class GstPylonSysMemBufferFactory : public GstPylonBufferFactory {
  public:
-  GstPylonSysMemBufferFactory() = default;
+  GstPylonSysMemBufferFactory(
+      GstPylonMemoryPagesEnum pages = PROP_MEMORY_PAGES_DEFAULT,
+      bool lock = PROP_MEMORY_LOCK_DEFAULT,
+      gint numa_node = PROP_NUMA_NODE_DEFAULT);
   virtual void SetConfig(const GstCaps *caps) override{};
   virtual void AllocateBuffer(size_t buffer_size, void **p_created_buffer,
                               intptr_t &buffer_context) override;
@@ -49,6 +53,17 @@ class GstPylonSysMemBufferFactory : public GstPylonBufferFactory {
 
  private:
   size_t RoundUp(size_t N, size_t S) { return ((((N) + (S)-1) / (S)) * (S)); }
+#if defined(__linux__)
+  void *AllocateHugePages(size_t size);
+  void BindToNode(void *buffer, size_t size);
+  void Prefault(void *buffer, size_t size);
+
+  size_t huge_page_size;
+#endif
+
+  GstPylonMemoryPagesEnum pages;
+  bool lock;
+  gint numa_node;
 };
 
 #endif
@@ -0,0 +1,183 @@
+/* Copyright (C) 2024 Basler AG
+ *
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *     1. Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *     2. Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *     3. Neither the name of the copyright holder nor the names of
+ *        its contributors may be used to endorse or promote products
+ *        derived from this software without specific prior written
+ *        permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "gstpylonthread.h"
+
+#if defined(__linux__)
+#  include <dirent.h>
+#  include <sched.h>
+#endif
+
+#include <cerrno>
+#include <vector>
+
+static gboolean gst_pylon_thread_parse_cpu_list(const gchar *cpu_list,
+                                                std::vector<guint> &cpus) {
+  gchar **ranges = NULL;
+  gboolean ret = TRUE;
+
+  if (!cpu_list || '\0' == cpu_list[0]) {
+    return FALSE;
+  }
+
+  ranges = g_strsplit(cpu_list, ",", -1);
+  for (gchar **range = ranges; *range && ret; range++) {
+    gchar **bounds = g_strsplit(g_strstrip(*range), "-", 2);
+    guint64 first = 0;
+    guint64 last = 0;
+
+    ret = g_ascii_string_to_unsigned(bounds[0], 10, 0, G_MAXUINT16, &first,
+                                     NULL);
+    if (ret && bounds[1]) {
+      ret = g_ascii_string_to_unsigned(bounds[1], 10, first, G_MAXUINT16,
+                                       &last, NULL);
+    } else {
+      last = first;
+    }
+
+    for (guint64 cpu = first; ret && cpu <= last; cpu++) {
+      cpus.push_back(cpu);
+    }
+    g_strfreev(bounds);
+  }
+  g_strfreev(ranges);
+
+  return ret;
+}
+
+gboolean gst_pylon_thread_affinity_is_valid(const gchar *cpu_list) {
+  std::vector<guint> cpus;
+
+  return gst_pylon_thread_parse_cpu_list(cpu_list, cpus);
+}
+
+gboolean gst_pylon_thread_set_affinity(const gchar *cpu_list, GError **err) {
+  std::vector<guint> cpus;
+
+  g_return_val_if_fail(err && *err == NULL, FALSE);
+
+  if (!gst_pylon_thread_parse_cpu_list(cpu_list, cpus)) {
+    g_set_error(err, GST_LIBRARY_ERROR, GST_LIBRARY_ERROR_SETTINGS,
+                "Invalid CPU list \"%s\"", cpu_list);
+    return FALSE;
+  }
+
+#if defined(__linux__)
+  cpu_set_t set;
+
+  CPU_ZERO(&set);
+  for (const auto &cpu : cpus) {
+    if (cpu >= CPU_SETSIZE) {
+      g_set_error(err, GST_LIBRARY_ERROR, GST_LIBRARY_ERROR_SETTINGS,
+                  "CPU %u exceeds the maximum of %d CPUs", cpu, CPU_SETSIZE);
+      return FALSE;
+    }
+    CPU_SET(cpu, &set);
+  }
+
+  /* A pid of 0 refers to the calling thread, not the whole process */
+  if (0 != sched_setaffinity(0, sizeof(set), &set)) {
+    g_set_error(err, GST_LIBRARY_ERROR, GST_LIBRARY_ERROR_FAILED,
+                "Unable to set thread affinity to \"%s\": %s", cpu_list,
+                g_strerror(errno));
+    return FALSE;
+  }
+
+  return TRUE;
+#else
+  g_set_error(err, GST_LIBRARY_ERROR, GST_LIBRARY_ERROR_FAILED,
+              "Thread affinity is only supported on Linux");
+  return FALSE;
+#endif
+}
+
+gchar *gst_pylon_thread_get_affinity(GError **err) {
+  g_return_val_if_fail(err && *err == NULL, NULL);
+
+#if defined(__linux__)
+  GString *cpu_list = g_string_new(NULL);
+  cpu_set_t set;
+
+  CPU_ZERO(&set);
+  if (0 != sched_getaffinity(0, sizeof(set), &set)) {
+    g_set_error(err, GST_LIBRARY_ERROR, GST_LIBRARY_ERROR_FAILED,
+                "Unable to get thread affinity: %s", g_strerror(errno));
+    g_string_free(cpu_list, TRUE);
+    return NULL;
+  }
+
+  for (guint cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+    if (CPU_ISSET(cpu, &set)) {
+      g_string_append_printf(cpu_list, "%s%u", cpu_list->len ? "," : "", cpu);
+    }
+  }
+
+  return g_string_free(cpu_list, FALSE);
+#else
+  g_set_error(err, GST_LIBRARY_ERROR, GST_LIBRARY_ERROR_FAILED,
+              "Thread affinity is only supported on Linux");
+  return NULL;
+#endif
+}
+
+gint gst_pylon_thread_get_affinity_node(const gchar *cpu_list) {
+  std::vector<guint> cpus;
+  gint node = -1;
+
+  if (!gst_pylon_thread_parse_cpu_list(cpu_list, cpus)) {
+    return -1;
+  }
+
+#if defined(__linux__)
+  /* The node of the first CPU, its sysfs directory links to it */
+  gchar *path = g_strdup_printf("/sys/devices/system/cpu/cpu%u", cpus[0]);
+  DIR *dir = opendir(path);
+  struct dirent *entry = NULL;
+
+  while (dir && (entry = readdir(dir))) {
+    guint64 value = 0;
+    if (g_str_has_prefix(entry->d_name, "node") &&
+        g_ascii_string_to_unsigned(entry->d_name + 4, 10, 0, G_MAXINT, &value,
+                                   NULL)) {
+      node = value;
+      break;
+    }
+  }
+
+  if (dir) {
+    closedir(dir);
+  }
+  g_free(path);
+#endif
+
+  return node;
+}
@@ -0,0 +1,149 @@
+/* Copyright (C) 2024 Basler AG
+ *
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *     1. Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *     2. Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *     3. Neither the name of the copyright holder nor the names of
+ *        its contributors may be used to endorse or promote products
+ *        derived from this software without specific prior written
+ *        permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "gst/pylon/gstpylondebug.h"
+#include "gstpylontimestampmapper.h"
+
+#include <algorithm>
+#include <cmath>
+
+/* A sample this far off the current fit means one of the clocks jumped,
+ * e.g. the camera timestamp was reset, and the history is discarded */
+constexpr double DISCONTINUITY_THRESHOLD = GST_SECOND;
+
+GstPylonTimestampMapper::GstPylonTimestampMapper(size_t window_size)
+    : samples(window_size) {
+  this->Reset();
+}
+
+void GstPylonTimestampMapper::Reset() {
+  this->next = 0;
+  this->count = 0;
+  this->valid = false;
+  this->origin_ticks = 0;
+  this->origin_time = 0;
+  this->ticks_mean = 0;
+  this->time_mean = 0;
+  this->slope = 0;
+}
+
+void GstPylonTimestampMapper::AddSample(guint64 ticks, GstClockTime time) {
+  GstClockTime expected = GST_CLOCK_TIME_NONE;
+
+  if (!GST_CLOCK_TIME_IS_VALID(time)) {
+    return;
+  }
+
+  if (this->Map(ticks, expected) &&
+      std::fabs(static_cast<double>(time) - static_cast<double>(expected)) >
+          DISCONTINUITY_THRESHOLD) {
+    GST_INFO("Camera timestamp discontinuity, restarting clock mapping");
+    this->Reset();
+  }
+
+  this->samples[this->next] = {ticks, time};
+  this->next = (this->next + 1) % this->samples.size();
+  this->count = std::min(this->count + 1, this->samples.size());
+
+  this->Fit();
+}
+
+void GstPylonTimestampMapper::Fit() {
+  double ticks_sum = 0;
+  double time_sum = 0;
+  double covariance = 0;
+  double variance = 0;
+
+  if (this->count < 2) {
+    this->valid = false;
+    return;
+  }
+
+  /* Center the samples on the first one, absolute values would lose the
+   * precision needed for the products below */
+  const Sample &origin = this->samples[(this->next + this->samples.size() -
+                                        this->count) %
+                                       this->samples.size()];
+
+  for (size_t i = 0; i < this->count; i++) {
+    const Sample &sample = this->samples[i];
+    ticks_sum += static_cast<double>(
+        static_cast<gint64>(sample.ticks - origin.ticks));
+    time_sum += static_cast<double>(GST_CLOCK_DIFF(origin.time, sample.time));
+  }
+
+  const double ticks_mean = ticks_sum / this->count;
+  const double time_mean = time_sum / this->count;
+
+  for (size_t i = 0; i < this->count; i++) {
+    const Sample &sample = this->samples[i];
+    const double dticks = static_cast<double>(static_cast<gint64>(
+                              sample.ticks - origin.ticks)) -
+                          ticks_mean;
+    const double dtime =
+        static_cast<double>(GST_CLOCK_DIFF(origin.time, sample.time)) -
+        time_mean;
+    covariance += dticks * dtime;
+    variance += dticks * dticks;
+  }
+
+  if (variance <= 0 || covariance <= 0) {
+    this->valid = false;
+    return;
+  }
+
+  this->origin_ticks = origin.ticks;
+  this->origin_time = origin.time;
+  this->ticks_mean = ticks_mean;
+  this->time_mean = time_mean;
+  this->slope = covariance / variance;
+  this->valid = true;
+}
+
+bool GstPylonTimestampMapper::Map(guint64 ticks, GstClockTime &time) {
+  if (!this->valid) {
+    return false;
+  }
+
+  const double dticks =
+      static_cast<double>(static_cast<gint64>(ticks - this->origin_ticks));
+  const gint64 offset = std::llround(
+      this->time_mean + this->slope * (dticks - this->ticks_mean));
+
+  if (offset < 0 && static_cast<guint64>(-offset) > this->origin_time) {
+    return false;
+  }
+
+  time = this->origin_time + offset;
+
+  return true;
+}
@@ -0,0 +1,74 @@
+/* Copyright (C) 2024 Basler AG
+ *
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *     1. Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *     2. Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *     3. Neither the name of the copyright holder nor the names of
+ *        its contributors may be used to endorse or promote products
+ *        derived from this software without specific prior written
+ *        permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef GST_PYLON_TIMESTAMP_MAPPER_H
+#define GST_PYLON_TIMESTAMP_MAPPER_H
+
+#include <gst/gst.h>
+
+#include <vector>
+
+/* Maps camera timestamp ticks onto a GstClock by a least squares fit over a
+ * sliding window of (ticks, clock time) samples. The fit follows the drift
+ * between both clocks and averages out the jitter of individual samples. */
+class GstPylonTimestampMapper {
+ public:
+  explicit GstPylonTimestampMapper(size_t window_size);
+
+  void Reset();
+  void AddSample(guint64 ticks, GstClockTime time);
+  bool Map(guint64 ticks, GstClockTime &time);
+
+ private:
+  struct Sample {
+    guint64 ticks;
+    GstClockTime time;
+  };
+
+  void Fit();
+
+  std::vector<Sample> samples;
+  size_t next;
+  size_t count;
+
+  /* time = origin_time + time_mean + slope * (ticks - origin_ticks -
+   * ticks_mean). The origin is kept as integers, doubles can't hold
+   * nanosecond clock times or camera ticks exactly. */
+  bool valid;
+  guint64 origin_ticks;
+  GstClockTime origin_time;
+  double ticks_mean;
+  double time_mean;
+  double slope;
+};
+
+#endif
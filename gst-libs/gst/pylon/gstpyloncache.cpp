@@ -34,89 +34,317 @@
 
 #include <errno.h>
 #include <glib/gfileutils.h>
+#include <glib/gstdio.h>
 #include <gst/pylon/gstpylonincludes.h>
 
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
 #define DIRERR -1
 
+/* Binary cache file layout, in host byte order since the cache never
+ * leaves the machine:
+ *   header
+ *   guint32 buckets[bucket_count]  entry index + 1, 0 for an empty bucket
+ *   Entry entries[entry_count]
+ *   gchar names[names_size]        feature names, not NUL terminated
+ * Buckets are probed linearly starting at hash & (bucket_count - 1). */
+#define CACHE_MAGIC "GSTPYLC"
+#define CACHE_VERSION 1
+#define CACHE_BYTE_ORDER 0x01020304
+
+enum {
+  CACHE_TYPE_INT = 0,
+  CACHE_TYPE_DOUBLE = 1,
+};
+
+struct CacheHeader {
+  gchar magic[8];
+  guint32 version;
+  guint32 byte_order;
+  guint32 bucket_count;
+  guint32 entry_count;
+  guint32 names_size;
+  guint32 reserved;
+};
+
 /* prototypes */
 static std::string gst_pylon_cache_create_filepath(
-    const std::string &cache_filename);
+    const std::string &cache_filename, const std::string &extension);
 
 static std::string gst_pylon_cache_create_filepath(
-    const std::string &cache_filename) {
+    const std::string &cache_filename, const std::string &extension) {
   gchar *filename_hash =
       g_compute_checksum_for_string(G_CHECKSUM_SHA256, cache_filename.c_str(),
                                     strlen(cache_filename.c_str()));
   std::string filename_hash_str = filename_hash;
   g_free(filename_hash);
 
+  return GstPylonCache::GetDirectory() + "/" + filename_hash_str + extension;
+}
+
+/* FNV-1a, hashes without copying the name */
+static guint64 gst_pylon_cache_hash(const gchar *name, gsize length) {
+  guint64 hash = G_GUINT64_CONSTANT(14695981039346656037);
+
+  for (gsize i = 0; i < length; i++) {
+    hash ^= static_cast<guchar>(name[i]);
+    hash *= G_GUINT64_CONSTANT(1099511628211);
+  }
+
+  return hash;
+}
+
+std::string GstPylonCache::GetDirectory() {
   std::string dirpath = std::string(g_get_user_cache_dir()) + "/" + "gstpylon";
 
   /* Create gstpylon directory */
   gint dir_permissions = 0775;
   gint ret = g_mkdir_with_parents(dirpath.c_str(), dir_permissions);
-  std::string filepath = dirpath + "/" + filename_hash_str + ".config";
   if (DIRERR == ret) {
     std::string msg =
         "Failed to create " + dirpath + ": " + std::string(strerror(errno));
     GST_WARNING("%s", msg.c_str());
   }
 
-  return filepath;
+  return dirpath;
 }
 
 GstPylonCache::GstPylonCache(const std::string &name)
-    : filepath(gst_pylon_cache_create_filepath(name)),
-      feature_cache_dict(g_key_file_new()),
-      is_modified(FALSE) {
+    : filepath(gst_pylon_cache_create_filepath(name, ".cache")),
+      legacy_filepath(gst_pylon_cache_create_filepath(name, ".config")),
+      mapped_file(NULL),
+      buckets(NULL),
+      bucket_count(0),
+      entries(NULL),
+      entry_count(0),
+      names(NULL),
+      names_size(0) {
   /* load initial cache file */
-  if (!LoadCacheFile()) {
+  if (!LoadCacheFile() && !MigrateKeyFile()) {
     GST_LOG("No feature cache file found");
   }
 }
 
-GstPylonCache::~GstPylonCache() { g_key_file_free(this->feature_cache_dict); }
+GstPylonCache::~GstPylonCache() {
+  if (this->mapped_file) {
+    g_mapped_file_unref(this->mapped_file);
+  }
+}
 
 gboolean GstPylonCache::LoadCacheFile() {
-  gboolean ret = TRUE;
+  GError *err = NULL;
+  CacheHeader header;
 
-  /* Check if file exists */
-  ret = g_file_test(this->filepath.c_str(), G_FILE_TEST_EXISTS);
-  if (!ret) {
+  if (!g_file_test(this->filepath.c_str(), G_FILE_TEST_EXISTS)) {
     return FALSE;
   }
 
-  /* Check if file contents are valid, this also sets the content of the
-   * GKeyFile object if valid */
-  ret = g_key_file_load_from_file(
-      this->feature_cache_dict, this->filepath.c_str(), G_KEY_FILE_NONE, NULL);
-  if (!ret) {
+  GMappedFile *mapped_file =
+      g_mapped_file_new(this->filepath.c_str(), FALSE, &err);
+  if (!mapped_file) {
+    GST_WARNING("Failed to map feature cache %s: %s", this->filepath.c_str(),
+                err->message);
+    g_error_free(err);
+    return FALSE;
+  }
+
+  const gchar *contents = g_mapped_file_get_contents(mapped_file);
+  const gsize length = g_mapped_file_get_length(mapped_file);
+
+  /* Files of other versions are rebuilt, not converted */
+  if (length < sizeof(header)) {
+    goto invalid;
+  }
+
+  memcpy(&header, contents, sizeof(header));
+  if (0 != memcmp(header.magic, CACHE_MAGIC, sizeof(header.magic)) ||
+      CACHE_VERSION != header.version ||
+      CACHE_BYTE_ORDER != header.byte_order ||
+      0 == header.bucket_count ||
+      0 != (header.bucket_count & (header.bucket_count - 1)) ||
+      header.entry_count >= header.bucket_count ||
+      length != sizeof(header) + header.bucket_count * sizeof(guint32) +
+                    header.entry_count * sizeof(Entry) + header.names_size) {
+    goto invalid;
+  }
+
+  this->buckets =
+      reinterpret_cast<const guint32 *>(contents + sizeof(CacheHeader));
+  this->entries =
+      reinterpret_cast<const Entry *>(this->buckets + header.bucket_count);
+  this->names =
+      reinterpret_cast<const gchar *>(this->entries + header.entry_count);
+
+  for (guint32 i = 0; i < header.entry_count; i++) {
+    const Entry &entry = this->entries[i];
+    if (entry.name_offset > header.names_size ||
+        entry.name_length > header.names_size - entry.name_offset) {
+      goto invalid;
+    }
+  }
+
+  /* Every entry is referenced by exactly one bucket, the remaining empty
+   * buckets end the probe sequences */
+  {
+    std::vector<bool> referenced(header.entry_count, false);
+
+    for (guint32 i = 0; i < header.bucket_count; i++) {
+      const guint32 index = this->buckets[i];
+      if (0 == index) {
+        continue;
+      }
+      if (index > header.entry_count || referenced[index - 1]) {
+        goto invalid;
+      }
+      referenced[index - 1] = true;
+    }
+
+    if (std::find(referenced.begin(), referenced.end(), false) !=
+        referenced.end()) {
+      goto invalid;
+    }
+  }
+
+  this->bucket_count = header.bucket_count;
+  this->entry_count = header.entry_count;
+  this->names_size = header.names_size;
+  this->mapped_file = mapped_file;
+
+  return TRUE;
+
+invalid:
+  GST_WARNING("Ignoring invalid feature cache %s", this->filepath.c_str());
+  this->buckets = NULL;
+  this->entries = NULL;
+  this->names = NULL;
+  g_mapped_file_unref(mapped_file);
+
+  return FALSE;
+}
+
+/* Text caches store numbers without their type, integral values are taken
+ * as integers and accepted by GetDoubleProps as well */
+gboolean GstPylonCache::MigrateKeyFile() {
+  GKeyFile *key_file = g_key_file_new();
+  gchar **groups = NULL;
+
+  if (!g_file_test(this->legacy_filepath.c_str(), G_FILE_TEST_EXISTS) ||
+      !g_key_file_load_from_file(key_file, this->legacy_filepath.c_str(),
+                                 G_KEY_FILE_NONE, NULL)) {
+    g_key_file_free(key_file);
     return FALSE;
   }
+
+  groups = g_key_file_get_groups(key_file, NULL);
+  for (gchar **group = groups; *group; group++) {
+    gchar *min = g_key_file_get_value(key_file, *group, "min", NULL);
+    gchar *max = g_key_file_get_value(key_file, *group, "max", NULL);
+    GError *err = NULL;
+    gint64 flags = g_key_file_get_int64(key_file, *group, "flags", &err);
+    gchar *min_end = NULL;
+    gchar *max_end = NULL;
+
+    if (min && max && !err) {
+      gint64 int_min = g_ascii_strtoll(min, &min_end, 10);
+      gint64 int_max = g_ascii_strtoll(max, &max_end, 10);
+
+      if ('\0' == *min_end && '\0' == *max_end) {
+        this->SetIntProps(*group, int_min, int_max,
+                          static_cast<GParamFlags>(flags));
+      } else {
+        this->SetDoubleProps(*group, g_ascii_strtod(min, NULL),
+                             g_ascii_strtod(max, NULL),
+                             static_cast<GParamFlags>(flags));
+      }
+    }
+
+    g_clear_error(&err);
+    g_free(min);
+    g_free(max);
+  }
+
+  GST_INFO("Migrating %u features from %s", g_strv_length(groups),
+           this->legacy_filepath.c_str());
+
+  g_strfreev(groups);
+  g_key_file_free(key_file);
+
   return TRUE;
 }
 
-gboolean GstPylonCache::HasNewSettings() { return is_modified; }
+gboolean GstPylonCache::HasNewSettings() { return !this->pending.empty(); }
 
 void GstPylonCache::CreateCacheFile() {
   GError *file_err = NULL;
+  std::vector<Entry> all_entries;
+  std::string all_names;
+
+  /* Merge the mapped entries with the new ones, new ones take precedence */
+  for (guint32 i = 0; i < this->entry_count; i++) {
+    const Entry &entry = this->entries[i];
+    std::string name(this->names + entry.name_offset, entry.name_length);
+    if (this->pending.count(name)) {
+      continue;
+    }
+    Entry copy = entry;
+    copy.name_offset = all_names.size();
+    all_names += name;
+    all_entries.push_back(copy);
+  }
 
-#if defined(GLIB_VERSION_2_66) && GLIB_VERSION_MIN_REQUIRED >= GLIB_VERSION_2_66
-  gchar *contents = NULL;
-  gsize length = 0;
+  for (auto const &pair : this->pending) {
+    Entry copy = pair.second;
+    copy.name_offset = all_names.size();
+    copy.name_length = pair.first.size();
+    all_names += pair.first;
+    all_entries.push_back(copy);
+  }
+
+  /* Keep the load factor at or below one half */
+  guint32 bucket_count = 16;
+  while (bucket_count < 2 * all_entries.size()) {
+    bucket_count *= 2;
+  }
 
-  contents = g_key_file_to_data(this->feature_cache_dict, &length, NULL);
-  g_assert(contents != NULL);
+  std::vector<guint32> all_buckets(bucket_count, 0);
+  for (guint32 i = 0; i < all_entries.size(); i++) {
+    guint32 bucket = all_entries[i].hash & (bucket_count - 1);
+    while (all_buckets[bucket]) {
+      bucket = (bucket + 1) & (bucket_count - 1);
+    }
+    all_buckets[bucket] = i + 1;
+  }
 
+  CacheHeader header = {CACHE_MAGIC,
+                        CACHE_VERSION,
+                        CACHE_BYTE_ORDER,
+                        bucket_count,
+                        static_cast<guint32>(all_entries.size()),
+                        static_cast<guint32>(all_names.size()),
+                        0};
+
+  std::string contents;
+  contents.reserve(sizeof(header) + bucket_count * sizeof(guint32) +
+                   all_entries.size() * sizeof(Entry) + all_names.size());
+  contents.append(reinterpret_cast<const gchar *>(&header), sizeof(header));
+  contents.append(reinterpret_cast<const gchar *>(all_buckets.data()),
+                  all_buckets.size() * sizeof(guint32));
+  contents.append(reinterpret_cast<const gchar *>(all_entries.data()),
+                  all_entries.size() * sizeof(Entry));
+  contents.append(all_names);
+
+  /* Written to a temporary file and renamed, readers never see a partial
+   * cache */
+#if defined(GLIB_VERSION_2_66) && GLIB_VERSION_MIN_REQUIRED >= GLIB_VERSION_2_66
   gboolean ret = g_file_set_contents_full(
-      this->filepath.c_str(), contents, length,
+      this->filepath.c_str(), contents.data(), contents.size(),
       static_cast<GFileSetContentsFlags>(G_FILE_SET_CONTENTS_CONSISTENT), 0666,
       &file_err);
-
-  g_free(contents);
 #else
-  gboolean ret = g_key_file_save_to_file(this->feature_cache_dict,
-                                         this->filepath.c_str(), &file_err);
+  gboolean ret = g_file_set_contents(this->filepath.c_str(), contents.data(),
+                                     contents.size(), &file_err);
 #endif
 
   if (!ret) {
@@ -124,88 +352,105 @@ void GstPylonCache::CreateCacheFile() {
     g_error_free(file_err);
     throw Pylon::GenericException(file_err_str.c_str(), __FILE__, __LINE__);
   }
-}
 
-void GstPylonCache::SetIntegerAttribute(const char *feature,
-                                        const char *attribute,
-                                        const gint64 val) {
-  g_key_file_set_int64(this->feature_cache_dict, feature, attribute, val);
-  is_modified = true;
+  /* The text cache has been migrated */
+  if (g_file_test(this->legacy_filepath.c_str(), G_FILE_TEST_EXISTS)) {
+    g_remove(this->legacy_filepath.c_str());
+  }
 }
 
-void GstPylonCache::SetDoubleAttribute(const char *feature,
-                                       const char *attribute,
-                                       const gdouble val) {
-  g_key_file_set_double(this->feature_cache_dict, feature, attribute, val);
-  is_modified = true;
-}
+bool GstPylonCache::Lookup(const gchar *feature_name, Entry &entry) {
+  const gsize length = strlen(feature_name);
 
-bool GstPylonCache::GetIntegerAttribute(const char *feature,
-                                        const char *attribute, gint64 &val) {
-  GError *err = NULL;
+  if (!this->pending.empty()) {
+    auto it = this->pending.find(feature_name);
+    if (it != this->pending.end()) {
+      entry = it->second;
+      return true;
+    }
+  }
 
-  gint64 value =
-      g_key_file_get_int64(this->feature_cache_dict, feature, attribute, &err);
-  if (err) {
-    GST_WARNING("Could not read values for feature %s from file %s: %s",
-                feature, this->filepath.c_str(), err->message);
-    g_error_free(err);
+  if (!this->entry_count) {
     return false;
   }
-  val = value;
-  return true;
-}
-
-bool GstPylonCache::GetDoubleAttribute(const char *feature,
-                                       const char *attribute, gdouble &val) {
-  GError *err = NULL;
 
-  gdouble value =
-      g_key_file_get_double(this->feature_cache_dict, feature, attribute, &err);
-  if (err) {
-    GST_WARNING("Could not read values for feature %s from file %s: %s",
-                feature, this->filepath.c_str(), err->message);
-    g_error_free(err);
-    return false;
+  const guint64 hash = gst_pylon_cache_hash(feature_name, length);
+  guint32 bucket = hash & (this->bucket_count - 1);
+
+  /* The load factor guarantees an empty bucket, the probe count is bounded
+   * as well */
+  for (guint32 probe = 0; probe < this->bucket_count && this->buckets[bucket];
+       probe++) {
+    const Entry &candidate = this->entries[this->buckets[bucket] - 1];
+    if (candidate.hash == hash && candidate.name_length == length &&
+        0 == memcmp(this->names + candidate.name_offset, feature_name,
+                    length)) {
+      entry = candidate;
+      return true;
+    }
+    bucket = (bucket + 1) & (this->bucket_count - 1);
   }
-  val = value;
-  return true;
+
+  return false;
 }
 
 void GstPylonCache::SetIntProps(const gchar *feature_name, const gint64 min,
                                 const gint64 max, const GParamFlags flags) {
-  SetIntegerAttribute(feature_name, "min", min);
-  SetIntegerAttribute(feature_name, "max", max);
-  SetIntegerAttribute(feature_name, "flags", static_cast<gint64>(flags));
+  Entry entry = {};
+
+  entry.hash = gst_pylon_cache_hash(feature_name, strlen(feature_name));
+  entry.type = CACHE_TYPE_INT;
+  entry.flags = static_cast<guint32>(flags);
+  entry.min.int_value = min;
+  entry.max.int_value = max;
+
+  this->pending[feature_name] = entry;
 }
+
 void GstPylonCache::SetDoubleProps(const gchar *feature_name, const gdouble min,
                                    const gdouble max, const GParamFlags flags) {
-  SetDoubleAttribute(feature_name, "min", min);
-  SetDoubleAttribute(feature_name, "max", max);
-  SetIntegerAttribute(feature_name, "flags", static_cast<gint64>(flags));
+  Entry entry = {};
+
+  entry.hash = gst_pylon_cache_hash(feature_name, strlen(feature_name));
+  entry.type = CACHE_TYPE_DOUBLE;
+  entry.flags = static_cast<guint32>(flags);
+  entry.min.double_value = min;
+  entry.max.double_value = max;
+
+  this->pending[feature_name] = entry;
 }
 
 bool GstPylonCache::GetIntProps(const gchar *feature_name, gint64 &min,
                                 gint64 &max, GParamFlags &flags) {
-  if (!GetIntegerAttribute(feature_name, "min", min)) return false;
-  if (!GetIntegerAttribute(feature_name, "max", max)) return false;
-  gint64 flag_val = 0;
-  if (!GetIntegerAttribute(feature_name, "flags", flag_val)) return false;
+  Entry entry;
 
-  flags = static_cast<GParamFlags>(flag_val);
+  if (!this->Lookup(feature_name, entry) || CACHE_TYPE_INT != entry.type) {
+    return false;
+  }
+
+  min = entry.min.int_value;
+  max = entry.max.int_value;
+  flags = static_cast<GParamFlags>(entry.flags);
 
   return true;
 }
 
 bool GstPylonCache::GetDoubleProps(const char *feature_name, gdouble &min,
                                    gdouble &max, GParamFlags &flags) {
-  if (!GetDoubleAttribute(feature_name, "min", min)) return false;
-  if (!GetDoubleAttribute(feature_name, "max", max)) return false;
+  Entry entry;
 
-  gint64 flag_val = 0;
-  if (!GetIntegerAttribute(feature_name, "flags", flag_val)) return false;
+  if (!this->Lookup(feature_name, entry)) {
+    return false;
+  }
 
-  flags = static_cast<GParamFlags>(flag_val);
+  if (CACHE_TYPE_DOUBLE == entry.type) {
+    min = entry.min.double_value;
+    max = entry.max.double_value;
+  } else {
+    min = static_cast<gdouble>(entry.min.int_value);
+    max = static_cast<gdouble>(entry.max.int_value);
+  }
+  flags = static_cast<GParamFlags>(entry.flags);
 
   return true;
 }
@@ -36,11 +36,19 @@
 #include <gst/gst.h>
 
 #include <string>
+#include <unordered_map>
 
+/* Feature limits cache. The cache file is a versioned binary table with a
+ * hashed index, mapped read-only, so lookups neither parse nor allocate.
+ * New values are kept in memory until CreateCacheFile() rewrites the file
+ * atomically. Text caches of earlier versions are migrated on load. */
 class GST_PLUGIN_EXPORT GstPylonCache {
  public:
   GstPylonCache(const std::string &name);
   ~GstPylonCache();
+
+  /* Directory of the gstpylon cache files, created if missing */
+  static std::string GetDirectory();
   gboolean HasNewSettings();
 
   void SetIntProps(const gchar *feature_name, const gint64 min,
@@ -58,20 +66,33 @@ class GST_PLUGIN_EXPORT GstPylonCache {
   /* Persist cache to filesystem */
   void CreateCacheFile();
 
- private:
-  void SetIntegerAttribute(const char *feature, const char *attribute,
-                           const gint64 val);
-  void SetDoubleAttribute(const char *feature, const char *attribute,
-                          gdouble val);
+  /* Entry of the cache file, also used for values not yet written */
+  struct Entry {
+    guint64 hash;
+    guint32 name_offset;
+    guint32 name_length;
+    guint32 type;
+    guint32 flags;
+    union {
+      gint64 int_value;
+      gdouble double_value;
+    } min, max;
+  };
 
-  bool GetIntegerAttribute(const char *feature, const char *attribute,
-                           gint64 &val);
-  bool GetDoubleAttribute(const char *feature, const char *attribute,
-                          gdouble &val);
+ private:
+  bool Lookup(const gchar *feature_name, Entry &entry);
+  gboolean MigrateKeyFile();
 
   std::string filepath;
-  GKeyFile *feature_cache_dict;
-  gboolean is_modified;
+  std::string legacy_filepath;
+  GMappedFile *mapped_file;
+  const guint32 *buckets;
+  guint32 bucket_count;
+  const Entry *entries;
+  guint32 entry_count;
+  const gchar *names;
+  guint32 names_size;
+  std::unordered_map<std::string, Entry> pending;
 };
 
 #endif
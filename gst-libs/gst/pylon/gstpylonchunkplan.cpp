@@ -0,0 +1,268 @@
+/* Copyright (C) 2024 Basler AG
+ *
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *     1. Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *     2. Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *     3. Neither the name of the copyright holder nor the names of
+ *        its contributors may be used to endorse or promote products
+ *        derived from this software without specific prior written
+ *        permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include "config.h"
+#endif
+
+#include "gstpylonchunkplan.h"
+#include "gstpylondebug.h"
+#include "gstpylonfeaturewalker.h"
+
+GstPylonChunkPlan::GstPylonChunkPlan()
+    : layout(std::make_shared<GstPylonChunkLayout>(this->selection)) {}
+
+void GstPylonChunkPlan::Reset() {
+  this->layout = std::make_shared<GstPylonChunkLayout>(this->selection);
+}
+
+void GstPylonChunkPlan::SetSelection(
+    const std::vector<std::string> &selection) {
+  this->selection = selection;
+}
+
+std::shared_ptr<GstPylonChunkLayout> GstPylonChunkPlan::GetLayout() {
+  return this->layout;
+}
+
+static gboolean gst_pylon_chunk_type_is_supported(GenApi::INode *node) {
+  switch (node->GetPrincipalInterfaceType()) {
+    case GenApi::intfIInteger:
+    case GenApi::intfIBoolean:
+    case GenApi::intfIFloat:
+    case GenApi::intfIString:
+    case GenApi::intfIEnumeration:
+      return TRUE;
+    default:
+      return FALSE;
+  }
+}
+
+GstPylonChunkLayout::GstPylonChunkLayout(
+    const std::vector<std::string> &selection)
+    : selection(selection) {}
+
+/* A chunk with a selector is selected by its full field name or, for all
+ * selector values, by its node name */
+bool GstPylonChunkLayout::IsSelected(const std::string &node_name,
+                                     const std::string &name) {
+  if (this->selection.empty()) {
+    return true;
+  }
+
+  for (auto const &selected : this->selection) {
+    if (selected == name || selected == node_name) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+void GstPylonChunkLayout::Compile(GenApi::INodeMap &nodemap) {
+  GenApi::NodeList_t chunk_nodes;
+  nodemap.GetNodes(chunk_nodes);
+
+  for (auto &node : chunk_nodes) {
+    GenApi::INode *selector_node = NULL;
+
+    /* Only take into account valid Chunk nodes */
+    auto sel_node = dynamic_cast<GenApi::ISelector *>(node);
+    if (!GenApi::IsAvailable(node) || !node->IsFeature() ||
+        (node->GetName() == "Root") || !sel_node || sel_node->IsSelector()) {
+      continue;
+    }
+
+    if (!gst_pylon_chunk_type_is_supported(node)) {
+      GST_WARNING("Chunk %s not added. Chunk of type %d is not supported",
+                  node->GetName().c_str(), node->GetPrincipalInterfaceType());
+      continue;
+    }
+
+    std::vector<std::string> enum_values;
+    try {
+      enum_values = GstPylonFeatureWalker::process_selector_features(
+          node, &selector_node);
+    } catch (const Pylon::GenericException &e) {
+      GST_WARNING("Chunk %s not added: %s", node->GetName().c_str(),
+                  e.GetDescription());
+      continue;
+    }
+
+    /* If the number of selector values (stored in enum_values) is 1, leave
+     * selector_node NULL, hence treating the feature as a "direct" one. */
+    if (1 == enum_values.size()) {
+      selector_node = NULL;
+    }
+
+    for (auto const &sel_value : enum_values) {
+      Chunk chunk = {std::string(node->GetName()), "", 0,
+                     node->GetPrincipalInterfaceType(), 0};
+      std::string name = chunk.node_name;
+
+      if (selector_node) {
+        chunk.selector_name = std::string(selector_node->GetName());
+        try {
+          if (GenApi::intfIEnumeration ==
+              selector_node->GetPrincipalInterfaceType()) {
+            Pylon::CEnumParameter selparam(selector_node);
+            chunk.selector_value =
+                selparam.GetEntryByName(sel_value.c_str())->GetValue();
+          } else {
+            chunk.selector_value = std::stoll(sel_value);
+          }
+        } catch (const Pylon::GenericException &e) {
+          GST_WARNING("Chunk %s-%s not added: %s", name.c_str(),
+                      sel_value.c_str(), e.GetDescription());
+          continue;
+        }
+        name += "-" + sel_value;
+      }
+
+      if (!this->IsSelected(chunk.node_name, name)) {
+        continue;
+      }
+
+      chunk.field = g_quark_from_string(name.c_str());
+      this->chunks.push_back(chunk);
+    }
+  }
+
+  GST_DEBUG("Compiled chunk plan with %zu chunks", this->chunks.size());
+  this->compiled = true;
+}
+
+const std::vector<GstPylonChunkLayout::Step> &GstPylonChunkLayout::Resolve(
+    GenApi::INodeMap &nodemap) {
+  auto it = this->steps.find(&nodemap);
+  if (it != this->steps.end()) {
+    return it->second;
+  }
+
+  std::vector<Step> &steps = this->steps[&nodemap];
+  steps.reserve(this->chunks.size());
+
+  for (auto const &chunk : this->chunks) {
+    Step step = {nodemap.GetNode(chunk.node_name.c_str()), NULL,
+                 chunk.selector_value, chunk.type, chunk.field};
+
+    if (!chunk.selector_name.empty()) {
+      step.selector = nodemap.GetNode(chunk.selector_name.c_str());
+    }
+
+    if (!step.node || (!chunk.selector_name.empty() && !step.selector)) {
+      GST_WARNING("Chunk %s missing in grab buffer nodemap",
+                  g_quark_to_string(chunk.field));
+      continue;
+    }
+
+    steps.push_back(step);
+  }
+
+  return steps;
+}
+
+void GstPylonChunkLayout::Decode(
+    const Pylon::CBaslerUniversalGrabResultPtr &grab_result,
+    std::vector<GstPylonChunkValue> &values) {
+  std::lock_guard<std::mutex> lock(this->mutex);
+
+  GenApi::INodeMap &nodemap = grab_result->GetChunkDataNodeMap();
+
+  if (!this->compiled) {
+    this->Compile(nodemap);
+  }
+
+  const std::vector<Step> &steps = this->Resolve(nodemap);
+  GenApi::INode *last_selector = NULL;
+  gint64 last_selector_value = 0;
+
+  values.resize(steps.size());
+  size_t n_values = 0;
+
+  for (auto const &step : steps) {
+    GstPylonChunkValue &value = values[n_values];
+
+    try {
+      /* Steps of the same selector are consecutive, only write it once per
+       * value */
+      if (step.selector && (step.selector != last_selector ||
+                            step.selector_value != last_selector_value)) {
+        if (GenApi::intfIEnumeration ==
+            step.selector->GetPrincipalInterfaceType()) {
+          Pylon::CEnumParameter(step.selector).SetIntValue(step.selector_value);
+        } else {
+          Pylon::CIntegerParameter(step.selector).SetValue(step.selector_value);
+        }
+        last_selector = step.selector;
+        last_selector_value = step.selector_value;
+      }
+
+      switch (step.type) {
+        case GenApi::intfIInteger:
+          value.type = G_TYPE_INT64;
+          value.int_value = Pylon::CIntegerParameter(step.node).GetValue();
+          break;
+        case GenApi::intfIBoolean:
+          value.type = G_TYPE_BOOLEAN;
+          value.boolean_value = Pylon::CBooleanParameter(step.node).GetValue();
+          break;
+        case GenApi::intfIFloat:
+          value.type = G_TYPE_DOUBLE;
+          value.double_value = Pylon::CFloatParameter(step.node).GetValue();
+          break;
+        case GenApi::intfIString:
+          value.type = G_TYPE_STRING;
+          value.string_value =
+              Pylon::CStringParameter(step.node).GetValue().c_str();
+          break;
+        case GenApi::intfIEnumeration:
+          value.type = G_TYPE_STRING;
+          value.string_value =
+              Pylon::CEnumParameter(step.node).GetValue().c_str();
+          break;
+        default:
+          continue;
+      }
+    } catch (const Pylon::GenericException &e) {
+      /* The chunk is not part of this payload */
+      GST_LOG("Chunk %s not available: %s", g_quark_to_string(step.field),
+              e.GetDescription());
+      continue;
+    }
+
+    value.field = step.field;
+    n_values++;
+  }
+
+  values.resize(n_values);
+}
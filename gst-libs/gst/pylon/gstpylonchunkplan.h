@@ -0,0 +1,127 @@
+/* Copyright (C) 2024 Basler AG
+ *
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *     1. Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *     2. Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *     3. Neither the name of the copyright holder nor the names of
+ *        its contributors may be used to endorse or promote products
+ *        derived from this software without specific prior written
+ *        permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _GST_PYLON_CHUNK_PLAN_H_
+#define _GST_PYLON_CHUNK_PLAN_H_
+
+#include <gst/gst.h>
+#include <gst/pylon/gstpylonincludes.h>
+#include <gst/pylon/gstpylonmeta.h>
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/* A decoded chunk, self describing so it doesn't depend on the camera that
+ * produced it */
+struct GstPylonChunkValue {
+  GQuark field;
+  GType type;
+  union {
+    gint64 int_value;
+    gdouble double_value;
+    gboolean boolean_value;
+  };
+  std::string string_value;
+};
+
+/* Chunk extraction resolved once per streaming session. Which chunks are
+ * sent, their selectors and their field names only depend on the camera
+ * configuration, so the chunk nodemap is only walked for the first grab
+ * result. The nodemap of every other grab buffer is resolved by name once,
+ * after that decoding chunks only reads values. Buffers may be decoded from
+ * any thread, so decoding is serialized. */
+class GstPylonChunkLayout {
+ public:
+  /* An empty selection decodes every chunk */
+  explicit GstPylonChunkLayout(const std::vector<std::string> &selection);
+
+  void Decode(const Pylon::CBaslerUniversalGrabResultPtr &grab_result,
+              std::vector<GstPylonChunkValue> &values);
+
+ private:
+  struct Chunk {
+    std::string node_name;
+    std::string selector_name;
+    gint64 selector_value;
+    GenApi::EInterfaceType type;
+    GQuark field;
+  };
+
+  struct Step {
+    GenApi::INode *node;
+    GenApi::INode *selector;
+    gint64 selector_value;
+    GenApi::EInterfaceType type;
+    GQuark field;
+  };
+
+  void Compile(GenApi::INodeMap &nodemap);
+  const std::vector<Step> &Resolve(GenApi::INodeMap &nodemap);
+  bool IsSelected(const std::string &node_name, const std::string &name);
+
+  const std::vector<std::string> selection;
+  std::mutex mutex;
+  bool compiled = false;
+  std::vector<Chunk> chunks;
+  std::unordered_map<GenApi::INodeMap *, std::vector<Step>> steps;
+};
+
+class GstPylonChunkPlan {
+ public:
+  GstPylonChunkPlan();
+
+  /* Start a new layout, buffers of the previous session keep theirs */
+  void Reset();
+  void SetSelection(const std::vector<std::string> &selection);
+  std::shared_ptr<GstPylonChunkLayout> GetLayout();
+
+ private:
+  std::vector<std::string> selection;
+  std::shared_ptr<GstPylonChunkLayout> layout;
+};
+
+/* Chunk storage of a GstPylonMeta. The grab result is only decoded on first
+ * access, the chunks field of the meta is only built if requested. */
+struct _GstPylonMetaChunks {
+  Pylon::CBaslerUniversalGrabResultPtr grab_result;
+  std::shared_ptr<GstPylonChunkLayout> layout;
+
+  std::mutex mutex;
+  std::atomic<bool> decoded{false};
+  std::vector<GstPylonChunkValue> values;
+};
+
+#endif
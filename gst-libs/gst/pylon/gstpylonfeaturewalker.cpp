@@ -36,12 +36,14 @@
 
 #include "gstpylondebug.h"
 #include "gstpylonfeaturewalker.h"
+#include "gstpylonintrospection.h"
 #include "gstpylonparamfactory.h"
 
 #include <string.h>
 
 #include <queue>
 #include <unordered_set>
+#include <vector>
 
 #define MAX_INT_SELECTOR_ENTRIES 16
 
@@ -301,10 +303,10 @@ void gst_pylon_camera_install_specs(const std::vector<GParamSpec*>& specs_list,
   }
 }
 
-void GstPylonFeatureWalker::install_properties(
-    GObjectClass* oclass, GenApi::INodeMap& nodemap,
-    const std::string& device_fullname, GstPylonCache& feature_cache) {
-  g_return_if_fail(oclass);
+/* Collects the features that get installed as properties */
+static std::vector<GenApi::INode*> gst_pylon_collect_features(
+    GenApi::INodeMap& nodemap) {
+  std::vector<GenApi::INode*> features;
 
   /* handle filter for debugging */
   const char* single_feature = NULL;
@@ -313,10 +315,6 @@ void GstPylonFeatureWalker::install_properties(
     single_feature = env_p;
   }
 
-  auto param_factory =
-      GstPylonParamFactory(nodemap, device_fullname, feature_cache);
-
-  gint nprop = 1;
   GenApi::INode* root_node = nodemap.GetNode("Root");
   auto worklist = std::queue<GenApi::INode*>();
 
@@ -338,37 +336,28 @@ void GstPylonFeatureWalker::install_properties(
         node->GetPrincipalInterfaceType() != GenApi::intfICommand &&
         node->GetPrincipalInterfaceType() != GenApi::intfIRegister &&
         sel_node && !sel_node->IsSelector()) {
-      GenICam::gcstring value;
-      GenICam::gcstring attrib;
-
-      try {
-        if (!single_feature ||
-            (single_feature && std::string(node->GetName().c_str()) ==
-                                   std::string(single_feature))) {
-          GST_DEBUG("Install node %s", node->GetName().c_str());
-          std::vector<GParamSpec*> specs_list =
-              gst_pylon_camera_handle_node(node, param_factory);
-
-          gst_pylon_camera_install_specs(specs_list, oclass, nprop);
-        }
-      } catch (const Pylon::GenericException& e) {
-        GST_DEBUG("Unable to install property \"%s\" on device \"%s\": %s",
-                  node->GetName().c_str(), device_fullname.c_str(),
-                  e.GetDescription());
+      if (!single_feature ||
+          (single_feature && std::string(node->GetName().c_str()) ==
+                                 std::string(single_feature))) {
+        features.push_back(node);
       }
     }
 
     /* Walk down all categories */
     if (category_node &&
         !is_unsupported_category(std::string(node->GetName()))) {
-      GenApi::FeatureList_t features;
-      category_node->GetFeatures(features);
-      for (auto const& f : features) {
+      GenApi::FeatureList_t category_features;
+      category_node->GetFeatures(category_features);
+      for (auto const& f : category_features) {
         worklist.push(f->GetNode());
       }
     }
   }
 
+  return features;
+}
+
+static void gst_pylon_save_feature_cache(GstPylonCache& feature_cache) {
   if (feature_cache.HasNewSettings()) {
     try {
       feature_cache.CreateCacheFile();
@@ -378,3 +367,44 @@ void GstPylonFeatureWalker::install_properties(
     }
   }
 }
+
+void GstPylonFeatureWalker::query_limits(GenApi::INodeMap& nodemap,
+                                         GstPylonCache& feature_cache) {
+  std::vector<GenApi::INode*> features = gst_pylon_collect_features(nodemap);
+
+  gst_pylon_query_features_limits(nodemap, features, feature_cache);
+
+  gst_pylon_save_feature_cache(feature_cache);
+}
+
+void GstPylonFeatureWalker::install_properties(
+    GObjectClass* oclass, GenApi::INodeMap& nodemap,
+    const std::string& device_fullname, GstPylonCache& feature_cache) {
+  g_return_if_fail(oclass);
+
+  auto param_factory =
+      GstPylonParamFactory(nodemap, device_fullname, feature_cache);
+
+  gint nprop = 1;
+  std::vector<GenApi::INode*> features = gst_pylon_collect_features(nodemap);
+
+  /* Limits shared by many features are found in one sweep up front, the
+   * features then find them in the cache as they are installed */
+  gst_pylon_query_features_limits(nodemap, features, feature_cache);
+
+  for (const auto& node : features) {
+    try {
+      GST_DEBUG("Install node %s", node->GetName().c_str());
+      std::vector<GParamSpec*> specs_list =
+          gst_pylon_camera_handle_node(node, param_factory);
+
+      gst_pylon_camera_install_specs(specs_list, oclass, nprop);
+    } catch (const Pylon::GenericException& e) {
+      GST_DEBUG("Unable to install property \"%s\" on device \"%s\": %s",
+                node->GetName().c_str(), device_fullname.c_str(),
+                e.GetDescription());
+    }
+  }
+
+  gst_pylon_save_feature_cache(feature_cache);
+}
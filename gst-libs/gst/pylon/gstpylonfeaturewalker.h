@@ -43,6 +43,10 @@ class GstPylonFeatureWalker {
                                  GenApi::INodeMap& nodemap,
                                  const std::string& device_fullname,
                                  GstPylonCache& feature_cache);
+  /* Adds the limits of the direct features to the cache and saves it,
+   * creates no types so it may run on any thread */
+  static void query_limits(GenApi::INodeMap& nodemap,
+                           GstPylonCache& feature_cache);
   static std::vector<std::string> process_selector_features(
       GenApi::INode* node, GenApi::INode** selector_node);
 };
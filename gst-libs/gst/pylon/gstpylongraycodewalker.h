@@ -0,0 +1,85 @@
+/* Copyright (C) 2024 Basler AG
+ *
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *     1. Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *     2. Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *     3. Neither the name of the copyright holder nor the names of
+ *        its contributors may be used to endorse or promote products
+ *        derived from this software without specific prior written
+ *        permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _GST_PYLON_GRAY_CODE_WALKER_H_
+#define _GST_PYLON_GRAY_CODE_WALKER_H_
+
+#include <cstddef>
+#include <numeric>
+#include <vector>
+
+/* Visits all the combinations of a set of values in reflected mixed radix
+ * Gray code order, consecutive combinations differ in a single position
+ * (Knuth, TAOCP 7.2.1.1, Algorithm H). Combinations are generated one at a
+ * time, every position must hold at least two values. */
+class GstPylonGrayCodeWalker {
+ public:
+  GstPylonGrayCodeWalker(const std::vector<size_t> &radices)
+      : radices(radices),
+        values(radices.size(), 0),
+        directions(radices.size(), 1),
+        focus(radices.size() + 1) {
+    std::iota(this->focus.begin(), this->focus.end(), 0);
+  }
+
+  /* Moves to the next combination and returns the position that changed,
+   * or the number of positions once all combinations have been visited,
+   * also on further calls */
+  size_t Next() {
+    const size_t n = this->radices.size();
+    const size_t j = this->focus[0];
+
+    if (n == j) {
+      return n;
+    }
+    this->focus[0] = 0;
+
+    this->values[j] += this->directions[j];
+    if (0 == this->values[j] || this->radices[j] - 1 == this->values[j]) {
+      this->directions[j] = -this->directions[j];
+      this->focus[j] = this->focus[j + 1];
+      this->focus[j + 1] = j + 1;
+    }
+
+    return j;
+  }
+
+  size_t GetValue(size_t position) const { return this->values[position]; }
+
+ private:
+  std::vector<size_t> radices;
+  std::vector<size_t> values;
+  std::vector<long> directions;
+  std::vector<size_t> focus;
+};
+
+#endif
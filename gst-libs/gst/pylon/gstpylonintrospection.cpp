@@ -37,6 +37,7 @@
 #include "gstpylondebug.h"
 #include "gstpylonfeaturewalker.h"
 #include "gstpylonformatmapping.h"
+#include "gstpylongraycodewalker.h"
 #include "gstpylonintrospection.h"
 #include "gstpylonobject.h"
 #include "gstpylonparamspecs.h"
@@ -45,6 +46,9 @@
 
 #include <algorithm>
 #include <chrono>
+#include <cmath>
+#include <limits>
+#include <map>
 #include <numeric>
 #include <set>
 #include <unordered_map>
@@ -53,9 +57,21 @@
 class GstPylonActions {
  public:
   void virtual set_value() = 0;
+  /* The feature holds the value, or can't be read to tell */
+  bool virtual is_applied() = 0;
   virtual ~GstPylonActions() = default;
 };
 
+template <class V>
+static bool gst_pylon_action_value_equals(const V &a, const V &b) {
+  return a == b;
+}
+
+/* Cameras may round float values they are written */
+static bool gst_pylon_action_value_equals(const gdouble &a, const gdouble &b) {
+  return std::fabs(a - b) <= 1e-6 * std::max(1.0, std::fabs(b));
+}
+
 template <class P, class V>
 class GstPylonTypeAction : public GstPylonActions {
  public:
@@ -64,6 +80,14 @@ class GstPylonTypeAction : public GstPylonActions {
     this->value = value;
   }
   void set_value() override { this->param.SetValue(this->value); }
+  bool is_applied() override {
+    try {
+      return gst_pylon_action_value_equals(
+          static_cast<V>(this->param.GetValue()), this->value);
+    } catch (const GenICam::GenericException &) {
+      return true;
+    }
+  }
 
  private:
   P param;
@@ -80,9 +104,6 @@ void gst_pylon_add_all_property_values(
     std::unordered_map<std::string, GenApi::INode *> &invalidators);
 std::vector<GenApi::INode *> gst_pylon_get_available_features(
     const std::set<GenApi::INode *> &feature_list);
-template <class Type>
-std::vector<std::vector<Type>> gst_pylon_cartesian_product(
-    std::vector<std::vector<Type>> &v);
 template <class P, class T>
 T gst_pylon_check_for_feature_invalidators(
     GenApi::INode *feature_node, GenApi::INode *limit_node, std::string limit,
@@ -90,6 +111,9 @@ T gst_pylon_check_for_feature_invalidators(
 template <class P, class T>
 T gst_pylon_query_feature_limits(GenApi::INode *feature_node,
                                  const std::string &limit);
+template <class T>
+T gst_pylon_query_limit_bound(GenApi::INode *limit_node,
+                              const std::string &limit);
 std::vector<std::vector<GstPylonActions *>> gst_pylon_create_set_value_actions(
     const std::vector<GenApi::INode *> &node_list);
 template <class P, class T>
@@ -305,24 +329,6 @@ static std::vector<GenApi::INode *> gst_pylon_filter_gev_ctrl(
   return valid_features;
 }
 
-template <class Type>
-std::vector<std::vector<Type>> gst_pylon_cartesian_product(
-    std::vector<std::vector<Type>> &values) {
-  std::vector<std::vector<Type>> result;
-  auto product = [](long long a, std::vector<Type> &b) { return a * b.size(); };
-  const long long N = accumulate(values.begin(), values.end(), 1LL, product);
-  std::vector<Type> result_combination(values.size());
-  for (long long n = 0; n < N; ++n) {
-    lldiv_t div_result{n, 0};
-    for (long long i = values.size() - 1; 0 <= i; --i) {
-      div_result = div(div_result.quot, values[i].size());
-      result_combination[i] = values[i][div_result.rem];
-    }
-    result.push_back(result_combination);
-  }
-  return result;
-}
-
 template <class P, class T>
 T gst_pylon_query_feature_limits(GenApi::INode *node,
                                  const std::string &limit) {
@@ -337,6 +343,48 @@ T gst_pylon_query_feature_limits(GenApi::INode *node,
   }
 }
 
+/* Range of the node a limit is read from, the limit can't go beyond it.
+ * That range is only a bound if it is fixed, if it is itself provided by a
+ * node with invalidators it may grow while the sweep runs. */
+template <class T>
+T gst_pylon_query_limit_bound(GenApi::INode *limit_node,
+                              const std::string &limit) {
+  const T unbounded = "max" == limit ? std::numeric_limits<T>::max()
+                                     : std::numeric_limits<T>::lowest();
+  GenICam::gcstring value;
+  GenICam::gcstring attribute;
+
+  if (!limit_node) {
+    return unbounded;
+  }
+
+  try {
+    GenApi::INode *bound_node =
+        gst_pylon_find_limit_node(limit_node, "max" == limit ? "pMax" : "pMin");
+    if (bound_node &&
+        bound_node->GetProperty("pInvalidator", value, attribute)) {
+      return unbounded;
+    }
+
+    switch (limit_node->GetPrincipalInterfaceType()) {
+      case GenApi::intfIInteger: {
+        Pylon::CIntegerParameter param(limit_node);
+        return static_cast<T>("max" == limit ? param.GetMax()
+                                             : param.GetMin());
+      }
+      case GenApi::intfIFloat: {
+        Pylon::CFloatParameter param(limit_node);
+        return static_cast<T>("max" == limit ? param.GetMax()
+                                             : param.GetMin());
+      }
+      default:
+        return unbounded;
+    }
+  } catch (const GenICam::GenericException &) {
+    return unbounded;
+  }
+}
+
 template <class P, class T>
 T gst_pylon_check_for_feature_invalidators(
     GenApi::INode *node, GenApi::INode *limit_node, std::string limit,
@@ -501,15 +549,18 @@ class TimeLogger {
   std::vector<std::string> info_list;
 };
 
+/* Finds the features the limits of a node depend on. Returns FALSE if the
+ * limits are known without sweeping them, either because they don't depend
+ * on other features or through a workaround. */
 template <class P, class T>
-void gst_pylon_find_limits(GenApi::INode *node, T &minimum_under_all_settings,
-                           T &maximum_under_all_settings) {
+gboolean gst_pylon_find_limit_invalidators(
+    GenApi::INode *node, T &minimum_under_all_settings,
+    T &maximum_under_all_settings,
+    std::vector<GenApi::INode *> &available_parent_inv) {
   std::unordered_map<std::string, GenApi::INode *> invalidators;
   maximum_under_all_settings = 0;
   minimum_under_all_settings = 0;
-  g_return_if_fail(node);
-
-  auto tl = TimeLogger(node->GetName().c_str());
+  g_return_val_if_fail(node, FALSE);
 
   /* Find the maximum value of a feature under the influence of other elements
    * of the nodemap */
@@ -525,7 +576,7 @@ void gst_pylon_find_limits(GenApi::INode *node, T &minimum_under_all_settings,
 
   /* Return if no invalidator nodes found */
   if (invalidators.empty()) {
-    return;
+    return FALSE;
   }
 
   /* Find all features that control the node and
@@ -540,8 +591,7 @@ void gst_pylon_find_limits(GenApi::INode *node, T &minimum_under_all_settings,
   }
 
   /* Filter parent invalidators to only available ones */
-  std::vector<GenApi::INode *> available_parent_inv =
-      gst_pylon_get_available_features(parent_invalidators);
+  available_parent_inv = gst_pylon_get_available_features(parent_invalidators);
 
   /* workarounds for ace2/dart2/boost features high
    * dependency count
@@ -551,12 +601,12 @@ void gst_pylon_find_limits(GenApi::INode *node, T &minimum_under_all_settings,
     GST_DEBUG("Apply ExposureTime feature workaround");
     minimum_under_all_settings = 1.0;
     maximum_under_all_settings = 1e+07;
-    return;
+    return FALSE;
   } else if (node->GetName() == "BlackLevel") {
     GST_DEBUG("Apply BlackLevel 12bit feature workaround");
     minimum_under_all_settings = 0;
     maximum_under_all_settings = 4095;
-    return;
+    return FALSE;
   } else if (node->GetName() == "OffsetX") {
     GST_DEBUG("Apply OffsetX feature workaround");
     Pylon::CIntegerParameter sensor_width(
@@ -566,7 +616,7 @@ void gst_pylon_find_limits(GenApi::INode *node, T &minimum_under_all_settings,
     if (sensor_width.IsValid() && width.IsValid()) {
       minimum_under_all_settings = 0;
       maximum_under_all_settings = sensor_width.GetValue() - width.GetInc();
-      return;
+      return FALSE;
     }
   } else if (node->GetName() == "OffsetY") {
     GST_DEBUG("Apply OffsetY feature workaround");
@@ -577,7 +627,7 @@ void gst_pylon_find_limits(GenApi::INode *node, T &minimum_under_all_settings,
     if (sensor_height.IsValid() && height.IsValid()) {
       minimum_under_all_settings = 0;
       maximum_under_all_settings = sensor_height.GetValue() - height.GetInc();
-      return;
+      return FALSE;
     }
   } else if (node->GetName() == "AutoFunctionROIOffsetX" ||
              node->GetName() == "AutoFunctionAOIOffsetX") {
@@ -589,7 +639,7 @@ void gst_pylon_find_limits(GenApi::INode *node, T &minimum_under_all_settings,
     if (sensor_width.IsValid() && width.IsValid()) {
       minimum_under_all_settings = 0;
       maximum_under_all_settings = sensor_width.GetValue() - width.GetInc();
-      return;
+      return FALSE;
     }
   } else if (node->GetName() == "AutoFunctionROIOffsetY" ||
              node->GetName() == "AutoFunctionAOIOffsetY") {
@@ -601,7 +651,7 @@ void gst_pylon_find_limits(GenApi::INode *node, T &minimum_under_all_settings,
     if (sensor_height.IsValid() && height.IsValid()) {
       minimum_under_all_settings = 0;
       maximum_under_all_settings = sensor_height.GetValue() - height.GetInc();
-      return;
+      return FALSE;
     }
   } else if (node->GetName() == "AutoFunctionROIWidth" ||
              node->GetName() == "AutoFunctionAOIWidth") {
@@ -612,7 +662,7 @@ void gst_pylon_find_limits(GenApi::INode *node, T &minimum_under_all_settings,
     if (sensor_width.IsValid()) {
       minimum_under_all_settings = 0;
       maximum_under_all_settings = sensor_width.GetValue();
-      return;
+      return FALSE;
     }
   } else if (node->GetName() == "AutoFunctionROIHeight" ||
              node->GetName() == "AutoFunctionAOIHeight") {
@@ -623,43 +673,43 @@ void gst_pylon_find_limits(GenApi::INode *node, T &minimum_under_all_settings,
     if (sensor_height.IsValid()) {
       minimum_under_all_settings = 0;
       maximum_under_all_settings = sensor_height.GetValue();
-      return;
+      return FALSE;
     }
   } else if (node->GetName() == "AcquisitionBurstFrameCount") {
     minimum_under_all_settings = 1;
     maximum_under_all_settings = 1023;
     GST_DEBUG("Apply AcquisitionBurstFrameCount feature workaround");
-    return;
+    return FALSE;
   } else if (node->GetName() == "BslColorAdjustmentHue") {
     minimum_under_all_settings = -1;
     maximum_under_all_settings = 1;
     GST_DEBUG("Apply BslColorAdjustmentHue feature workaround");
-    return;
+    return FALSE;
   } else if (node->GetName() == "BslColorAdjustmentSaturation") {
     minimum_under_all_settings = 0;
     maximum_under_all_settings = 2;
     GST_DEBUG("Apply BslColorAdjustmentSaturation feature workaround");
-    return;
+    return FALSE;
   } else if (node->GetName() == "GevSCBWR") {
     minimum_under_all_settings = 0;
     maximum_under_all_settings = 100;
     GST_DEBUG("Apply GevSCBWR feature workaround");
-    return;
+    return FALSE;
   } else if (node->GetName() == "GevSCBWRA") {
     minimum_under_all_settings = 1;
     maximum_under_all_settings = 512;
     GST_DEBUG("Apply GevSCBWRA feature workaround");
-    return;
+    return FALSE;
   } else if (node->GetName() == "GevSCPD") {
     minimum_under_all_settings = 0;
     maximum_under_all_settings = 50000000;
     GST_DEBUG("Apply GevSCPD feature workaround");
-    return;
+    return FALSE;
   } else if (node->GetName() == "GevSCFTD") {
     minimum_under_all_settings = 0;
     maximum_under_all_settings = 50000000;
     GST_DEBUG("Apply GevSCFTD feature workaround");
-    return;
+    return FALSE;
   };
 
   /* remove any feature from the list that belongs to an unsupported
@@ -670,53 +720,254 @@ void gst_pylon_find_limits(GenApi::INode *node, T &minimum_under_all_settings,
    * the gige setup parameters */
   available_parent_inv = gst_pylon_filter_gev_ctrl(available_parent_inv);
 
-  for (auto &node : available_parent_inv) {
-    tl.add_info(node->GetName().c_str());
+  return TRUE;
+}
+
+static bool gst_pylon_cache_get_limits(GstPylonCache &feature_cache,
+                                       const gchar *name, gint64 &minimum,
+                                       gint64 &maximum, GParamFlags &flags) {
+  return feature_cache.GetIntProps(name, minimum, maximum, flags);
+}
+
+static bool gst_pylon_cache_get_limits(GstPylonCache &feature_cache,
+                                       const gchar *name, gdouble &minimum,
+                                       gdouble &maximum, GParamFlags &flags) {
+  return feature_cache.GetDoubleProps(name, minimum, maximum, flags);
+}
+
+static void gst_pylon_cache_set_limits(GstPylonCache &feature_cache,
+                                       const gchar *name, gint64 minimum,
+                                       gint64 maximum, GParamFlags flags) {
+  feature_cache.SetIntProps(name, minimum, maximum, flags);
+}
+
+static void gst_pylon_cache_set_limits(GstPylonCache &feature_cache,
+                                       const gchar *name, gdouble minimum,
+                                       gdouble maximum, GParamFlags flags) {
+  feature_cache.SetDoubleProps(name, minimum, maximum, flags);
+}
+
+/* Records the limits of a feature while its invalidators are swept */
+class GstPylonLimitProbe {
+ public:
+  void virtual sample() = 0;
+  bool virtual has_samples() = 0;
+  /* The limits can't widen any further */
+  bool virtual is_final() = 0;
+  void virtual store(GstPylonCache &feature_cache) = 0;
+  virtual ~GstPylonLimitProbe() = default;
+};
+
+template <class P, class T>
+class GstPylonTypeLimitProbe : public GstPylonLimitProbe {
+ public:
+  GstPylonTypeLimitProbe(GenApi::INode *node, GParamFlags flags) {
+    GenApi::INode *pmax_node = gst_pylon_find_limit_node(node, "pMax");
+    GenApi::INode *pmin_node = gst_pylon_find_limit_node(node, "pMin");
+    GenICam::gcstring value;
+    GenICam::gcstring attribute;
+
+    this->node = node;
+    this->flags = flags;
+    this->sampled = false;
+    this->minimum = 0;
+    this->maximum = 0;
+
+    /* The limits are final once they reach the range of the nodes
+     * providing them. Limits without invalidators don't change at all. */
+    if (pmax_node && pmax_node->GetProperty("pInvalidator", value, attribute)) {
+      this->pmax_node = pmax_node;
+      this->max_bound = gst_pylon_query_limit_bound<T>(pmax_node, "max");
+    } else {
+      this->pmax_node = NULL;
+      this->max_bound = std::numeric_limits<T>::lowest();
+    }
+    if (pmin_node && pmin_node->GetProperty("pInvalidator", value, attribute)) {
+      this->pmin_node = pmin_node;
+      this->min_bound = gst_pylon_query_limit_bound<T>(pmin_node, "min");
+    } else {
+      this->pmin_node = NULL;
+      this->min_bound = std::numeric_limits<T>::max();
+    }
+  }
+
+  void sample() override {
+    T current_min = 0;
+    T current_max = 0;
+
+    /* Some states might not allow reading the limits, skip them */
+    try {
+      current_min = gst_pylon_query_feature_limits<P, T>(this->node, "min");
+      current_max = gst_pylon_query_feature_limits<P, T>(this->node, "max");
+    } catch (const GenICam::GenericException &e) {
+      GST_DEBUG("failed to query limits of %s: %s",
+                this->node->GetName().c_str(), e.GetDescription());
+      return;
+    }
+
+    /* A bound that moves with the invalidators can't end the sweep early */
+    if (this->pmax_node &&
+        gst_pylon_query_limit_bound<T>(this->pmax_node, "max") !=
+            this->max_bound) {
+      this->pmax_node = NULL;
+      this->max_bound = std::numeric_limits<T>::max();
+    }
+    if (this->pmin_node &&
+        gst_pylon_query_limit_bound<T>(this->pmin_node, "min") !=
+            this->min_bound) {
+      this->pmin_node = NULL;
+      this->min_bound = std::numeric_limits<T>::lowest();
+    }
+
+    if (this->sampled) {
+      this->minimum = std::min(this->minimum, current_min);
+      this->maximum = std::max(this->maximum, current_max);
+    } else {
+      this->minimum = current_min;
+      this->maximum = current_max;
+      this->sampled = true;
+    }
+  }
+
+  bool has_samples() override { return this->sampled; }
+
+  bool is_final() override {
+    return this->sampled && this->maximum >= this->max_bound &&
+           this->minimum <= this->min_bound;
+  }
+
+  void store(GstPylonCache &feature_cache) override {
+    gst_pylon_cache_set_limits(feature_cache, this->node->GetName().c_str(),
+                               this->minimum, this->maximum, this->flags);
   }
 
+  T get_minimum() { return this->minimum; }
+  T get_maximum() { return this->maximum; }
+
+ private:
+  GenApi::INode *node;
+  GenApi::INode *pmin_node;
+  GenApi::INode *pmax_node;
+  GParamFlags flags;
+  bool sampled;
+  T minimum;
+  T maximum;
+  T min_bound;
+  T max_bound;
+};
+
+/* Walks all the combinations of the invalidator values and samples every
+ * probe at each of them. Stops as soon as no probe can widen its limits
+ * any further. */
+static void gst_pylon_sweep_invalidators(
+    GenApi::INodeMap *nodemap, const std::vector<GenApi::INode *> &invalidators,
+    const std::vector<GstPylonLimitProbe *> &probes) {
   /* Save current set of values */
   std::vector<GstPylonActions *> reset_list =
-      gst_pylon_create_reset_value_actions(available_parent_inv);
+      gst_pylon_create_reset_value_actions(invalidators);
 
   /* Create list of extreme value settings per invalidator */
   std::vector<std::vector<GstPylonActions *>> actions_list =
-      gst_pylon_create_set_value_actions(available_parent_inv);
+      gst_pylon_create_set_value_actions(invalidators);
 
   /* try to get support for optimized bulk feature settings */
   auto reg_streaming_start = Pylon::CCommandParameter(
-      node->GetNodeMap()->GetNode("DeviceRegistersStreamingStart"));
-  auto reg_streaming_end = Pylon::CCommandParameter(
-      node->GetNodeMap()->GetNode("DeviceRegistersStreamingEnd"));
-
-  /* Create list of all possible setting permutations and execute them all */
-  auto action_list_permutations = gst_pylon_cartesian_product(actions_list);
-  std::vector<T> min_values;
-  std::vector<T> max_values;
-  for (const auto &actions : action_list_permutations) {
-    reg_streaming_start.TryExecute();
-    for (const auto &action : actions) {
-      /* Some states might not be valid, so just skip them */
-      try {
-        action->set_value();
-      } catch (const GenICam::GenericException &e) {
-        GST_DEBUG("failed to set action");
-        continue;
+      nodemap->GetNode("DeviceRegistersStreamingStart"));
+  auto reg_streaming_end =
+      Pylon::CCommandParameter(nodemap->GetNode("DeviceRegistersStreamingEnd"));
+
+  auto sample = [&probes]() {
+    for (const auto &probe : probes) {
+      probe->sample();
+    }
+  };
+  auto is_final = [&probes]() {
+    return std::all_of(probes.begin(), probes.end(),
+                       [](GstPylonLimitProbe *probe) {
+                         return probe->is_final();
+                       });
+  };
+
+  auto apply = [](GstPylonActions *action) {
+    try {
+      action->set_value();
+    } catch (const GenICam::GenericException &e) {
+      GST_DEBUG("failed to set action: %s", e.GetDescription());
+    }
+  };
+
+  /* Writing an invalidator may change others, e.g. a width clamping an
+   * offset, and a failed write might only succeed once other invalidators
+   * have changed. Once the writes reached the device, re-read all of them
+   * and re-apply the ones that don't hold their value of the current
+   * combination, until they settle. */
+  std::vector<size_t> current(actions_list.size(), 0);
+  auto settle = [&actions_list, &current, &apply]() {
+    for (size_t pass = 0; pass < actions_list.size(); pass++) {
+      bool drifted = false;
+      for (size_t i = 0; i < actions_list.size(); i++) {
+        if (actions_list[i].empty()) {
+          continue;
+        }
+        GstPylonActions *action = actions_list[i][current[i]];
+        if (!action->is_applied()) {
+          drifted = true;
+          apply(action);
+        }
       }
+      if (!drifted) {
+        return;
+      }
+    }
+    GST_DEBUG("Invalidators did not settle");
+  };
+
+  /* Start from the first value of every invalidator, invalidators with a
+   * single value keep it for the whole sweep */
+  std::vector<size_t> positions;
+  std::vector<size_t> radices;
+  reg_streaming_start.TryExecute();
+  for (size_t i = 0; i < actions_list.size(); i++) {
+    if (actions_list[i].empty()) {
+      continue;
+    }
+    apply(actions_list[i][0]);
+    if (actions_list[i].size() > 1) {
+      positions.push_back(i);
+      radices.push_back(actions_list[i].size());
+    }
+  }
+  reg_streaming_end.TryExecute();
+  settle();
+
+  sample();
+
+  /* Walk the remaining combinations, each step writes a single invalidator
+   * unless others drifted or failed to apply */
+  GstPylonGrayCodeWalker walker(radices);
+  guint64 steps = 1;
+  for (size_t step = walker.Next(); step < radices.size();
+       step = walker.Next()) {
+    if (is_final()) {
+      GST_DEBUG("Limits reached their bounds after %" G_GUINT64_FORMAT
+                " combinations",
+                steps);
+      break;
     }
 
+    const size_t position = positions[step];
+    current[position] = walker.GetValue(step);
+
+    reg_streaming_start.TryExecute();
+    apply(actions_list[position][current[position]]);
     reg_streaming_end.TryExecute();
+    settle();
 
     /* Capture min and max values after all setting are applied*/
-    min_values.push_back(gst_pylon_query_feature_limits<P, T>(node, "min"));
-    max_values.push_back(gst_pylon_query_feature_limits<P, T>(node, "max"));
+    sample();
+    steps++;
   }
 
-  /* Get the max and min values under all settings executed*/
-  minimum_under_all_settings =
-      *std::min_element(min_values.begin(), min_values.end());
-  maximum_under_all_settings =
-      *std::max_element(max_values.begin(), max_values.end());
-
   /* Reset to old values */
   for (const auto &action : reset_list) {
     try {
@@ -737,6 +988,129 @@ void gst_pylon_find_limits(GenApi::INode *node, T &minimum_under_all_settings,
   }
 }
 
+template <class P, class T>
+void gst_pylon_find_limits(GenApi::INode *node, T &minimum_under_all_settings,
+                           T &maximum_under_all_settings) {
+  std::vector<GenApi::INode *> invalidators;
+
+  g_return_if_fail(node);
+
+  auto tl = TimeLogger(node->GetName().c_str());
+
+  if (!gst_pylon_find_limit_invalidators<P, T>(node, minimum_under_all_settings,
+                                               maximum_under_all_settings,
+                                               invalidators)) {
+    return;
+  }
+
+  for (auto &inv : invalidators) {
+    tl.add_info(inv->GetName().c_str());
+  }
+
+  GstPylonTypeLimitProbe<P, T> probe(node, G_PARAM_READABLE);
+  gst_pylon_sweep_invalidators(node->GetNodeMap(), invalidators, {&probe});
+
+  if (!probe.has_samples()) {
+    std::string msg = "Unable to query the limits of " +
+                      std::string(node->GetName().c_str());
+    throw Pylon::GenericException(msg.c_str(), __FILE__, __LINE__);
+  }
+
+  minimum_under_all_settings = probe.get_minimum();
+  maximum_under_all_settings = probe.get_maximum();
+}
+
+template <class P, class T>
+static void gst_pylon_add_limit_probe(
+    GenApi::INodeMap &nodemap, GenApi::INode *node,
+    GstPylonCache &feature_cache,
+    std::map<std::vector<GenApi::INode *>, std::vector<GstPylonLimitProbe *>>
+        &sweeps) {
+  std::vector<GenApi::INode *> invalidators;
+  GParamFlags flags = G_PARAM_READABLE;
+  T minimum_under_all_settings = 0;
+  T maximum_under_all_settings = 0;
+
+  if (gst_pylon_cache_get_limits(feature_cache, node->GetName().c_str(),
+                                 minimum_under_all_settings,
+                                 maximum_under_all_settings, flags)) {
+    return;
+  }
+
+  flags = gst_pylon_query_access(nodemap, node);
+
+  if (!gst_pylon_find_limit_invalidators<P, T>(node, minimum_under_all_settings,
+                                               maximum_under_all_settings,
+                                               invalidators)) {
+    gst_pylon_cache_set_limits(feature_cache, node->GetName().c_str(),
+                               minimum_under_all_settings,
+                               maximum_under_all_settings, flags);
+    return;
+  }
+
+  sweeps[invalidators].push_back(new GstPylonTypeLimitProbe<P, T>(node, flags));
+}
+
+void gst_pylon_query_features_limits(
+    GenApi::INodeMap &nodemap, const std::vector<GenApi::INode *> &features,
+    GstPylonCache &feature_cache) {
+  /* Probes grouped by the invalidators they depend on */
+  std::map<std::vector<GenApi::INode *>, std::vector<GstPylonLimitProbe *>>
+      sweeps;
+
+  for (const auto &node : features) {
+    GenApi::INode *selector = NULL;
+
+    try {
+      /* Limits of selected features are queried per selector value when
+       * they are installed */
+      std::vector<std::string> selector_values =
+          GstPylonFeatureWalker::process_selector_features(node, &selector);
+      if (1 != selector_values.size()) {
+        continue;
+      }
+
+      switch (node->GetPrincipalInterfaceType()) {
+        case GenApi::intfIInteger:
+          gst_pylon_add_limit_probe<Pylon::CIntegerParameter, gint64>(
+              nodemap, node, feature_cache, sweeps);
+          break;
+        case GenApi::intfIFloat:
+          gst_pylon_add_limit_probe<Pylon::CFloatParameter, gdouble>(
+              nodemap, node, feature_cache, sweeps);
+          break;
+        default:
+          break;
+      }
+    } catch (const Pylon::GenericException &e) {
+      GST_DEBUG("Unable to prepare limits of %s: %s", node->GetName().c_str(),
+                e.GetDescription());
+    }
+  }
+
+  for (const auto &sweep : sweeps) {
+    auto tl = TimeLogger("shared sweep of " +
+                         std::to_string(sweep.second.size()) + " features");
+    for (const auto &inv : sweep.first) {
+      tl.add_info(inv->GetName().c_str());
+    }
+
+    try {
+      gst_pylon_sweep_invalidators(&nodemap, sweep.first, sweep.second);
+    } catch (const Pylon::GenericException &e) {
+      GST_DEBUG("Unable to sweep invalidators: %s", e.GetDescription());
+    }
+
+    /* Features without results are introspected one by one later */
+    for (const auto &probe : sweep.second) {
+      if (probe->has_samples()) {
+        probe->store(feature_cache);
+      }
+      delete probe;
+    }
+  }
+}
+
 void gst_pylon_query_feature_properties_double(
     GenApi::INodeMap &nodemap, GenApi::INode *node,
     GstPylonCache &feature_cache, GParamFlags &flags,
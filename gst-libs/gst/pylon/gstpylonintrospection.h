@@ -37,6 +37,8 @@
 #include <gst/pylon/gstpyloncache.h>
 #include <gst/pylon/gstpylonincludes.h>
 
+#include <vector>
+
 GParamFlags gst_pylon_query_access(GenApi::INodeMap &nodemap,
                                    GenApi::INode *node);
 
@@ -52,4 +54,10 @@ void gst_pylon_query_feature_properties_integer(
     gint64 &minimum_under_all_settings, gint64 &maximum_under_all_settings,
     GenApi::INode *selector = NULL, gint64 selector_value = 0);
 
+/* Adds the limits of the integer and float features to the cache, features
+ * depending on the same invalidators are swept together */
+void gst_pylon_query_features_limits(
+    GenApi::INodeMap &nodemap, const std::vector<GenApi::INode *> &features,
+    GstPylonCache &feature_cache);
+
 #endif
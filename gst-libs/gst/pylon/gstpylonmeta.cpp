@@ -34,25 +34,56 @@
 #  include "config.h"
 #endif
 
+#include "gstpylonchunkplan.h"
 #include "gstpylondebug.h"
-#include "gstpylonfeaturewalker.h"
 #include "gstpylonmeta.h"
 #include "gstpylonmetaprivate.h"
 
+#include <gst/base/gstbytereader.h>
 #include <gst/pylon/gstpylonincludes.h>
 #include <gst/video/video.h>
 
+#include <cstring>
+
 /* prototypes */
 static gboolean gst_pylon_meta_init(GstMeta *meta, gpointer params,
                                     GstBuffer *buffer);
 static void gst_pylon_meta_free(GstMeta *meta, GstBuffer *buffer);
-static void gst_pylon_meta_add_chunk_as_meta(GstStructure *st,
-                                             GenApi::INode *node,
-                                             GenApi::INode *selector_node,
-                                             const guint64 &selector_value);
-static void gst_pylon_meta_fill_result_chunks(
-    GstPylonMeta *self,
-    const Pylon::CBaslerUniversalGrabResultPtr &grab_result_ptr);
+static gboolean gst_pylon_meta_transform(GstBuffer *transbuf, GstMeta *meta,
+                                         GstBuffer *buffer, GQuark type,
+                                         gpointer data);
+static void gst_pylon_meta_decode_chunks(GstPylonMetaChunks *chunks);
+#if GST_CHECK_VERSION(1, 24, 0)
+static gboolean gst_pylon_meta_serialize(const GstMeta *meta,
+                                         GstByteArrayInterface *data,
+                                         guint8 *version);
+static GstMeta *gst_pylon_meta_deserialize(const GstMetaInfo *info,
+                                           GstBuffer *buffer,
+                                           const guint8 *data, gsize size,
+                                           guint8 version);
+#endif
+
+/* Version of the binary serialization format */
+#define GST_PYLON_META_SERIALIZE_VERSION 0
+
+/* Chunk value type tags of the binary serialization format */
+enum {
+  GST_PYLON_META_CHUNK_INT64 = 0,
+  GST_PYLON_META_CHUNK_DOUBLE = 1,
+  GST_PYLON_META_CHUNK_BOOLEAN = 2,
+  GST_PYLON_META_CHUNK_STRING = 3,
+};
+
+/* Smallest serialized chunk: name length, tag and the smallest value, a
+ * string length. Other values take 8 bytes. */
+#define GST_PYLON_META_CHUNK_MIN_SIZE \
+  (sizeof(guint32) + sizeof(guint8) + sizeof(guint32))
+
+/* Quarks are never freed, so deserialization drops chunk names longer than
+ * any GenICam name and only interns a limited number of names not known to
+ * this process */
+#define GST_PYLON_META_MAX_FOREIGN_CHUNKS 1024
+#define GST_PYLON_META_MAX_CHUNK_NAME_LENGTH 256
 
 GType gst_pylon_meta_api_get_type(void) {
   static GType type = 0;
@@ -69,131 +100,67 @@ const GstMetaInfo *gst_pylon_meta_get_info(void) {
   static const GstMetaInfo *info = NULL;
 
   if (g_once_init_enter(&info)) {
+#if GST_CHECK_VERSION(1, 24, 0)
+    GstMetaInfo *meta_info = gst_meta_info_new(
+        GST_PYLON_META_API_TYPE, "GstPylonMeta", sizeof(GstPylonMeta));
+    meta_info->init_func = gst_pylon_meta_init;
+    meta_info->free_func = gst_pylon_meta_free;
+    meta_info->transform_func = gst_pylon_meta_transform;
+    meta_info->serialize_func = gst_pylon_meta_serialize;
+    meta_info->deserialize_func = gst_pylon_meta_deserialize;
+    const GstMetaInfo *meta = gst_meta_info_register(meta_info);
+#else
     const GstMetaInfo *meta = gst_meta_register(
         GST_PYLON_META_API_TYPE, "GstPylonMeta", sizeof(GstPylonMeta),
-        gst_pylon_meta_init, gst_pylon_meta_free, NULL);
+        gst_pylon_meta_init, gst_pylon_meta_free, gst_pylon_meta_transform);
+#endif
     g_once_init_leave(&info, meta);
   }
   return info;
 }
 
-static void gst_pylon_meta_add_chunk_as_meta(GstStructure *st,
-                                             GenApi::INode *node,
-                                             GenApi::INode *selector_node,
-                                             const guint64 &selector_value) {
-  g_return_if_fail(st);
-  g_return_if_fail(node);
-
-  GValue value = G_VALUE_INIT;
-  gboolean is_valid = TRUE;
-  gchar *name = NULL;
-
-  if (selector_node) {
-    Pylon::CEnumParameter selparam(selector_node);
-    selparam.SetIntValue(selector_value);
-    name = g_strdup_printf(
-        "%s-%s", node->GetName().c_str(),
-        selparam.GetEntry(selector_value)->GetSymbolic().c_str());
-  } else {
-    name = g_strdup(node->GetName().c_str());
-  }
-
-  GenApi::EInterfaceType iface = node->GetPrincipalInterfaceType();
-  switch (iface) {
-    case GenApi::intfIInteger:
-      g_value_init(&value, G_TYPE_INT64);
-      g_value_set_int64(&value, Pylon::CIntegerParameter(node).GetValue());
-      break;
-    case GenApi::intfIBoolean:
-      g_value_init(&value, G_TYPE_BOOLEAN);
-      g_value_set_boolean(&value, Pylon::CBooleanParameter(node).GetValue());
-      break;
-    case GenApi::intfIFloat:
-      g_value_init(&value, G_TYPE_DOUBLE);
-      g_value_set_double(&value, Pylon::CFloatParameter(node).GetValue());
-      break;
-    case GenApi::intfIString:
-      g_value_init(&value, G_TYPE_STRING);
-      g_value_set_string(&value, Pylon::CStringParameter(node).GetValue());
-      break;
-    case GenApi::intfIEnumeration:
-      g_value_init(&value, G_TYPE_STRING);
-      g_value_set_string(&value,
-                         Pylon::CEnumParameter(node).GetValue().c_str());
-      break;
-    default:
-      is_valid = FALSE;
-      GST_WARNING("Chunk %s not added. Chunk of type %d is not supported", name,
-                  node->GetPrincipalInterfaceType());
-      break;
-  }
-
-  if (is_valid) {
-    gst_structure_set_value(st, name, &value);
-  }
-
-  g_value_unset(&value);
-  g_free(name);
+GstPylonChunkPlan *gst_pylon_chunk_plan_new(void) {
+  return new GstPylonChunkPlan;
 }
 
-static void gst_pylon_meta_fill_result_chunks(
-    GstPylonMeta *self,
-    const Pylon::CBaslerUniversalGrabResultPtr &grab_result_ptr) {
-  g_return_if_fail(self);
-
-  GstStructure *st = self->chunks;
-
-  GenApi::INodeMap &chunk_nodemap = grab_result_ptr->GetChunkDataNodeMap();
-  GenApi::NodeList_t chunk_nodes;
-  chunk_nodemap.GetNodes(chunk_nodes);
+void gst_pylon_chunk_plan_free(GstPylonChunkPlan *plan) { delete plan; }
 
-  for (auto &node : chunk_nodes) {
-    GenApi::INode *selector_node = NULL;
-    guint64 selector_value = 0;
+void gst_pylon_chunk_plan_reset(GstPylonChunkPlan *plan) {
+  g_return_if_fail(plan);
 
-    /* Only take into account valid Chunk nodes */
-    auto sel_node = dynamic_cast<GenApi::ISelector *>(node);
-    if (!GenApi::IsAvailable(node) || !node->IsFeature() ||
-        (node->GetName() == "Root") || !sel_node || sel_node->IsSelector()) {
-      continue;
-    }
-
-    std::vector<std::string> enum_values;
-    try {
-      enum_values = GstPylonFeatureWalker::process_selector_features(
-          node, &selector_node);
-    } catch (const Pylon::GenericException &e) {
-      GST_WARNING("Chunk %s not added: %s", node->GetName().c_str(),
-                  e.GetDescription());
-      continue;
-    }
+  plan->Reset();
+}
 
-    Pylon::CEnumParameter param(selector_node);
+void gst_pylon_chunk_plan_set_selection(GstPylonChunkPlan *plan,
+                                        const gchar *const *chunks) {
+  std::vector<std::string> selection;
 
-    /* If the number of selector values (stored in enum_values) is 1, leave
-     * selector_node NULL, hence treating the feature as a "direct" one. */
-    if (1 == enum_values.size()) {
-      selector_node = NULL;
-    }
+  g_return_if_fail(plan);
 
-    for (auto const &sel_pair : enum_values) {
-      if (param.IsValid()) {
-        selector_value = param.GetEntryByName(sel_pair.c_str())->GetValue();
-      }
-      gst_pylon_meta_add_chunk_as_meta(st, node, selector_node, selector_value);
-    }
+  for (const gchar *const *chunk = chunks; chunk && *chunk; chunk++) {
+    selection.push_back(*chunk);
   }
+
+  plan->SetSelection(selection);
 }
 
 void gst_buffer_add_pylon_meta(
     GstBuffer *buffer,
-    const Pylon::CBaslerUniversalGrabResultPtr &grab_result_ptr) {
+    const Pylon::CBaslerUniversalGrabResultPtr &grab_result_ptr,
+    GstPylonChunkPlan *chunk_plan) {
   g_return_if_fail(buffer != NULL);
+  g_return_if_fail(chunk_plan != NULL);
 
-  GST_LOG("Adding Pylon chunk meta to buffer %p", buffer);
-
-  GstPylonMeta *self =
-      (GstPylonMeta *)gst_buffer_add_meta(buffer, GST_PYLON_META_INFO, NULL);
+  /* Buffers coming from a pool keep their meta, refill it in place */
+  GstPylonMeta *self = gst_buffer_get_pylon_meta(buffer);
+  if (self) {
+    GST_LOG("Reusing Pylon chunk meta of buffer %p", buffer);
+  } else {
+    GST_LOG("Adding Pylon chunk meta to buffer %p", buffer);
+    self =
+        (GstPylonMeta *)gst_buffer_add_meta(buffer, GST_PYLON_META_INFO, NULL);
+    GST_META_FLAG_SET(self, GST_META_FLAG_POOLED);
+  }
 
   /* Add meta to GstPylonMeta */
   self->block_id = grab_result_ptr->GetImageNumber();
@@ -204,16 +171,44 @@ void gst_buffer_add_pylon_meta(
   self->timestamp = grab_result_ptr->GetTimeStamp();
   grab_result_ptr->GetStride(self->stride);
 
+  /* Chunks are decoded on first access, until then the grab result is kept
+   * alongside the one held by the buffer memory */
+  GstPylonMetaChunks *chunks = self->chunk_data;
+  if (self->chunks) {
+    gst_structure_free(self->chunks);
+    self->chunks = NULL;
+  }
+
   if (grab_result_ptr->IsChunkDataAvailable()) {
-    gst_pylon_meta_fill_result_chunks(self, grab_result_ptr);
+    chunks->grab_result = grab_result_ptr;
+    chunks->layout = chunk_plan->GetLayout();
+  } else {
+    chunks->grab_result.Release();
+    chunks->layout.reset();
   }
+  chunks->decoded.store(false, std::memory_order_release);
+}
+
+void gst_buffer_release_pylon_meta(GstBuffer *buffer) {
+  g_return_if_fail(buffer != NULL);
+
+  GstPylonMeta *self = gst_buffer_get_pylon_meta(buffer);
+  if (!self) {
+    return;
+  }
+
+  GstPylonMetaChunks *chunks = self->chunk_data;
+  std::lock_guard<std::mutex> lock(chunks->mutex);
+  chunks->grab_result.Release();
+  chunks->layout.reset();
 }
 
 static gboolean gst_pylon_meta_init(GstMeta *meta, gpointer params,
                                     GstBuffer *buffer) {
   GstPylonMeta *pylon_meta = (GstPylonMeta *)meta;
 
-  pylon_meta->chunks = gst_structure_new_empty("meta/x-pylon");
+  pylon_meta->chunks = NULL;
+  pylon_meta->chunk_data = new GstPylonMetaChunks;
 
   return TRUE;
 }
@@ -221,10 +216,484 @@ static gboolean gst_pylon_meta_init(GstMeta *meta, gpointer params,
 static void gst_pylon_meta_free(GstMeta *meta, GstBuffer *buffer) {
   GstPylonMeta *pylon_meta = (GstPylonMeta *)meta;
 
-  gst_structure_free(pylon_meta->chunks);
+  if (pylon_meta->chunks) {
+    gst_structure_free(pylon_meta->chunks);
+  }
+  delete pylon_meta->chunk_data;
 }
 
 GstPylonMeta *gst_buffer_get_pylon_meta(GstBuffer *buffer) {
   return reinterpret_cast<GstPylonMeta *>(
       gst_buffer_get_meta(buffer, GST_PYLON_META_API_TYPE));
 }
+
+/* Copies carry the decoded chunks, never the grab result, so they don't
+ * keep pylon grab buffers alive */
+static gboolean gst_pylon_meta_transform(GstBuffer *transbuf, GstMeta *meta,
+                                         GstBuffer *buffer, GQuark type,
+                                         gpointer data) {
+  GstPylonMeta *src = (GstPylonMeta *)meta;
+  GstPylonMeta *dst = NULL;
+
+  /* Scaling and other video transforms invalidate offset and stride */
+  if (!GST_META_TRANSFORM_IS_COPY(type)) {
+    return FALSE;
+  }
+
+  /* So does copying only part of the frame */
+  if (((GstMetaTransformCopy *)data)->region) {
+    return FALSE;
+  }
+
+  dst = gst_buffer_get_pylon_meta(transbuf);
+  if (!dst) {
+    dst = (GstPylonMeta *)gst_buffer_add_meta(transbuf, GST_PYLON_META_INFO,
+                                              NULL);
+  }
+
+  dst->block_id = src->block_id;
+  dst->image_number = src->image_number;
+  dst->skipped_images = src->skipped_images;
+  dst->offset = src->offset;
+  dst->timestamp = src->timestamp;
+  dst->stride = src->stride;
+
+  gst_pylon_meta_decode_chunks(src->chunk_data);
+
+  GstPylonMetaChunks *chunks = dst->chunk_data;
+  std::lock_guard<std::mutex> lock(chunks->mutex);
+  chunks->grab_result.Release();
+  chunks->layout.reset();
+  chunks->values = src->chunk_data->values;
+  if (dst->chunks) {
+    gst_structure_free(dst->chunks);
+    dst->chunks = NULL;
+  }
+  chunks->decoded.store(true, std::memory_order_release);
+
+  return TRUE;
+}
+
+#if GST_CHECK_VERSION(1, 24, 0)
+static gboolean gst_pylon_meta_append_uint64(GstByteArrayInterface *data,
+                                             guint64 value) {
+  guint8 bytes[8];
+
+  GST_WRITE_UINT64_LE(bytes, value);
+  return gst_byte_array_interface_append_data(data, bytes, sizeof(bytes));
+}
+
+static gboolean gst_pylon_meta_append_uint32(GstByteArrayInterface *data,
+                                             guint32 value) {
+  guint8 bytes[4];
+
+  GST_WRITE_UINT32_LE(bytes, value);
+  return gst_byte_array_interface_append_data(data, bytes, sizeof(bytes));
+}
+
+/* Little endian: block id, image number, skipped images, offset x/y, pylon
+ * timestamp and stride as 64 bit values, the number of chunks as 32 bit
+ * value and per chunk its name (32 bit length and bytes), a type tag byte
+ * and the value. Strings are stored like names, all other values in 64
+ * bits. */
+static gboolean gst_pylon_meta_serialize(const GstMeta *meta,
+                                         GstByteArrayInterface *data,
+                                         guint8 *version) {
+  const GstPylonMeta *self = (const GstPylonMeta *)meta;
+  GstPylonMetaChunks *chunks = self->chunk_data;
+  gboolean ret = TRUE;
+
+  gst_pylon_meta_decode_chunks(chunks);
+
+  ret &= gst_pylon_meta_append_uint64(data, self->block_id);
+  ret &= gst_pylon_meta_append_uint64(data, self->image_number);
+  ret &= gst_pylon_meta_append_uint64(data, self->skipped_images);
+  ret &= gst_pylon_meta_append_uint64(data, self->offset.offset_x);
+  ret &= gst_pylon_meta_append_uint64(data, self->offset.offset_y);
+  ret &= gst_pylon_meta_append_uint64(data, self->timestamp);
+  ret &= gst_pylon_meta_append_uint64(data, self->stride);
+  ret &= gst_pylon_meta_append_uint32(data, chunks->values.size());
+
+  for (auto const &value : chunks->values) {
+    const gchar *name = g_quark_to_string(value.field);
+    const guint32 name_len = strlen(name);
+    guint8 tag = 0;
+    guint8 bytes[8];
+
+    ret &= gst_pylon_meta_append_uint32(data, name_len);
+    ret &= gst_byte_array_interface_append_data(
+        data, reinterpret_cast<const guint8 *>(name), name_len);
+
+    switch (value.type) {
+      case G_TYPE_INT64:
+        tag = GST_PYLON_META_CHUNK_INT64;
+        GST_WRITE_UINT64_LE(bytes, value.int_value);
+        break;
+      case G_TYPE_DOUBLE:
+        tag = GST_PYLON_META_CHUNK_DOUBLE;
+        GST_WRITE_DOUBLE_LE(bytes, value.double_value);
+        break;
+      case G_TYPE_BOOLEAN:
+        tag = GST_PYLON_META_CHUNK_BOOLEAN;
+        GST_WRITE_UINT64_LE(bytes, value.boolean_value ? 1 : 0);
+        break;
+      default:
+        tag = GST_PYLON_META_CHUNK_STRING;
+        break;
+    }
+
+    ret &= gst_byte_array_interface_append_data(data, &tag, sizeof(tag));
+    if (GST_PYLON_META_CHUNK_STRING == tag) {
+      ret &= gst_pylon_meta_append_uint32(data, value.string_value.size());
+      ret &= gst_byte_array_interface_append_data(
+          data, reinterpret_cast<const guint8 *>(value.string_value.data()),
+          value.string_value.size());
+    } else {
+      ret &= gst_byte_array_interface_append_data(data, bytes, sizeof(bytes));
+    }
+  }
+
+  *version = GST_PYLON_META_SERIALIZE_VERSION;
+
+  return ret;
+}
+
+/* Returns 0 for names that are dropped */
+static GQuark gst_pylon_meta_intern_chunk_name(const guint8 *name,
+                                               guint32 len) {
+  static std::mutex mutex;
+  static guint foreign_chunks = 0;
+
+  if (len > GST_PYLON_META_MAX_CHUNK_NAME_LENGTH || memchr(name, '\0', len)) {
+    return 0;
+  }
+
+  std::string str(reinterpret_cast<const gchar *>(name), len);
+  GQuark field = g_quark_try_string(str.c_str());
+  if (field) {
+    return field;
+  }
+
+  std::lock_guard<std::mutex> lock(mutex);
+  if (foreign_chunks >= GST_PYLON_META_MAX_FOREIGN_CHUNKS) {
+    return 0;
+  }
+  foreign_chunks++;
+
+  return g_quark_from_string(str.c_str());
+}
+
+/* Chunks with dropped names are read with a field of 0 */
+static gboolean gst_pylon_meta_read_chunk(GstByteReader *reader,
+                                          GstPylonChunkValue &value) {
+  guint32 len = 0;
+  const guint8 *name = NULL;
+  const guint8 *str = NULL;
+  guint8 tag = 0;
+  guint64 bits = 0;
+
+  if (!gst_byte_reader_get_uint32_le(reader, &len) ||
+      !gst_byte_reader_get_data(reader, len, &name) ||
+      !gst_byte_reader_get_uint8(reader, &tag)) {
+    return FALSE;
+  }
+
+  value.field = gst_pylon_meta_intern_chunk_name(name, len);
+
+  switch (tag) {
+    case GST_PYLON_META_CHUNK_INT64:
+      value.type = G_TYPE_INT64;
+      return gst_byte_reader_get_int64_le(reader, &value.int_value);
+    case GST_PYLON_META_CHUNK_DOUBLE:
+      value.type = G_TYPE_DOUBLE;
+      return gst_byte_reader_get_float64_le(reader, &value.double_value);
+    case GST_PYLON_META_CHUNK_BOOLEAN:
+      value.type = G_TYPE_BOOLEAN;
+      if (!gst_byte_reader_get_uint64_le(reader, &bits)) {
+        return FALSE;
+      }
+      value.boolean_value = 0 != bits;
+      return TRUE;
+    case GST_PYLON_META_CHUNK_STRING:
+      value.type = G_TYPE_STRING;
+      if (!gst_byte_reader_get_uint32_le(reader, &len) ||
+          !gst_byte_reader_get_data(reader, len, &str)) {
+        return FALSE;
+      }
+      value.string_value.assign(reinterpret_cast<const gchar *>(str), len);
+      return TRUE;
+    default:
+      return FALSE;
+  }
+}
+
+static GstMeta *gst_pylon_meta_deserialize(const GstMetaInfo *info,
+                                           GstBuffer *buffer,
+                                           const guint8 *data, gsize size,
+                                           guint8 version) {
+  GstByteReader reader = GST_BYTE_READER_INIT(data, size);
+  guint64 fields[7];
+  guint32 n_chunks = 0;
+  gboolean ret = TRUE;
+
+  if (GST_PYLON_META_SERIALIZE_VERSION != version) {
+    GST_WARNING("Unsupported GstPylonMeta serialization version %u", version);
+    return NULL;
+  }
+
+  for (auto &field : fields) {
+    ret &= gst_byte_reader_get_uint64_le(&reader, &field);
+  }
+  ret &= gst_byte_reader_get_uint32_le(&reader, &n_chunks);
+
+  /* Don't trust the count blindly */
+  if (!ret || n_chunks > gst_byte_reader_get_remaining(&reader) /
+                             GST_PYLON_META_CHUNK_MIN_SIZE) {
+    GST_WARNING("Truncated GstPylonMeta");
+    return NULL;
+  }
+
+  GstPylonMeta *self = (GstPylonMeta *)gst_buffer_add_meta(buffer, info, NULL);
+  self->block_id = fields[0];
+  self->image_number = fields[1];
+  self->skipped_images = fields[2];
+  self->offset.offset_x = fields[3];
+  self->offset.offset_y = fields[4];
+  self->timestamp = fields[5];
+  self->stride = fields[6];
+
+  GstPylonMetaChunks *chunks = self->chunk_data;
+  chunks->values.reserve(n_chunks);
+  for (guint32 i = 0; i < n_chunks; i++) {
+    GstPylonChunkValue value;
+
+    if (!gst_pylon_meta_read_chunk(&reader, value)) {
+      GST_WARNING("Invalid chunk in serialized GstPylonMeta");
+      gst_buffer_remove_meta(buffer, (GstMeta *)self);
+      return NULL;
+    }
+
+    if (!value.field) {
+      GST_DEBUG("Dropping chunk with an unknown name");
+      continue;
+    }
+    chunks->values.push_back(std::move(value));
+  }
+  chunks->decoded.store(true, std::memory_order_release);
+
+  return (GstMeta *)self;
+}
+#endif
+
+static void gst_pylon_meta_decode_chunks(GstPylonMetaChunks *chunks) {
+  if (chunks->decoded.load(std::memory_order_acquire)) {
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(chunks->mutex);
+  if (chunks->decoded.load(std::memory_order_relaxed)) {
+    return;
+  }
+
+  if (chunks->grab_result.IsValid() && chunks->layout) {
+    chunks->layout->Decode(chunks->grab_result, chunks->values);
+  } else {
+    chunks->values.clear();
+  }
+  chunks->grab_result.Release();
+  chunks->layout.reset();
+
+  chunks->decoded.store(true, std::memory_order_release);
+}
+
+static const GstPylonChunkValue *gst_pylon_meta_lookup_chunk(
+    const GstPylonMeta *meta, const gchar *name) {
+  g_return_val_if_fail(meta, NULL);
+  g_return_val_if_fail(name, NULL);
+
+  /* A name that was never interned can't be a chunk */
+  GQuark field = g_quark_try_string(name);
+  if (!field) {
+    return NULL;
+  }
+
+  gst_pylon_meta_decode_chunks(meta->chunk_data);
+
+  for (auto const &value : meta->chunk_data->values) {
+    if (value.field == field) {
+      return &value;
+    }
+  }
+
+  return NULL;
+}
+
+static const GstPylonChunkValue *gst_pylon_meta_find_chunk(
+    const GstPylonMeta *meta, const gchar *name, GType type) {
+  auto chunk = gst_pylon_meta_lookup_chunk(meta, name);
+
+  return chunk && chunk->type == type ? chunk : NULL;
+}
+
+GType gst_pylon_meta_get_chunk_type(const GstPylonMeta *meta,
+                                    const gchar *name) {
+  auto chunk = gst_pylon_meta_lookup_chunk(meta, name);
+
+  return chunk ? chunk->type : G_TYPE_INVALID;
+}
+
+gboolean gst_pylon_meta_get_chunk_int64(const GstPylonMeta *meta,
+                                        const gchar *name, gint64 *value) {
+  g_return_val_if_fail(value, FALSE);
+
+  auto chunk = gst_pylon_meta_find_chunk(meta, name, G_TYPE_INT64);
+  if (!chunk) {
+    return FALSE;
+  }
+
+  *value = chunk->int_value;
+  return TRUE;
+}
+
+gboolean gst_pylon_meta_get_chunk_double(const GstPylonMeta *meta,
+                                         const gchar *name, gdouble *value) {
+  g_return_val_if_fail(value, FALSE);
+
+  auto chunk = gst_pylon_meta_find_chunk(meta, name, G_TYPE_DOUBLE);
+  if (!chunk) {
+    return FALSE;
+  }
+
+  *value = chunk->double_value;
+  return TRUE;
+}
+
+gboolean gst_pylon_meta_get_chunk_boolean(const GstPylonMeta *meta,
+                                          const gchar *name, gboolean *value) {
+  g_return_val_if_fail(value, FALSE);
+
+  auto chunk = gst_pylon_meta_find_chunk(meta, name, G_TYPE_BOOLEAN);
+  if (!chunk) {
+    return FALSE;
+  }
+
+  *value = chunk->boolean_value;
+  return TRUE;
+}
+
+const gchar *gst_pylon_meta_get_chunk_string(const GstPylonMeta *meta,
+                                             const gchar *name) {
+  auto chunk = gst_pylon_meta_find_chunk(meta, name, G_TYPE_STRING);
+  if (!chunk) {
+    return NULL;
+  }
+
+  return chunk->string_value.c_str();
+}
+
+const GstStructure *gst_pylon_meta_get_chunks(const GstPylonMeta *meta) {
+  g_return_val_if_fail(meta, NULL);
+
+  GstPylonMetaChunks *chunks = meta->chunk_data;
+
+  gst_pylon_meta_decode_chunks(chunks);
+
+  std::lock_guard<std::mutex> lock(chunks->mutex);
+  if (meta->chunks) {
+    return meta->chunks;
+  }
+
+  GstStructure *st = gst_structure_new_empty("meta/x-pylon");
+  for (auto const &value : chunks->values) {
+    switch (value.type) {
+      case G_TYPE_INT64:
+        gst_structure_id_set(st, value.field, G_TYPE_INT64, value.int_value,
+                             NULL);
+        break;
+      case G_TYPE_DOUBLE:
+        gst_structure_id_set(st, value.field, G_TYPE_DOUBLE,
+                             value.double_value, NULL);
+        break;
+      case G_TYPE_BOOLEAN:
+        gst_structure_id_set(st, value.field, G_TYPE_BOOLEAN,
+                             value.boolean_value, NULL);
+        break;
+      case G_TYPE_STRING:
+        gst_structure_id_set(st, value.field, G_TYPE_STRING,
+                             value.string_value.c_str(), NULL);
+        break;
+      default:
+        break;
+    }
+  }
+  /* The structure is a cache of the decoded values, filling it doesn't
+   * change the meta as seen by its users */
+  const_cast<GstPylonMeta *>(meta)->chunks = st;
+
+  return st;
+}
+
+#define GST_PYLON_META_PARAMS_NAME "GstPylonMetaParams"
+#define GST_PYLON_META_PARAMS_CHUNKS "chunks"
+
+void gst_pylon_meta_request_chunks(GstQuery *query,
+                                   const gchar *const *chunks) {
+  const GstStructure *params = NULL;
+  gchar **requested = NULL;
+  guint index = 0;
+
+  g_return_if_fail(GST_IS_QUERY(query));
+  g_return_if_fail(chunks);
+
+  GPtrArray *merged = g_ptr_array_new_with_free_func(g_free);
+
+  if (gst_query_find_allocation_meta(query, GST_PYLON_META_API_TYPE, &index)) {
+    gst_query_parse_nth_allocation_meta(query, index, &params);
+    if (params) {
+      gst_structure_get(params, GST_PYLON_META_PARAMS_CHUNKS, G_TYPE_STRV,
+                        &requested, NULL);
+    }
+    gst_query_remove_nth_allocation_meta(query, index);
+  }
+
+  for (gchar **chunk = requested; chunk && *chunk; chunk++) {
+    g_ptr_array_add(merged, g_strdup(*chunk));
+  }
+
+  for (const gchar *const *chunk = chunks; *chunk; chunk++) {
+    if (!requested || !g_strv_contains(requested, *chunk)) {
+      g_ptr_array_add(merged, g_strdup(*chunk));
+    }
+  }
+  g_ptr_array_add(merged, NULL);
+
+  GstStructure *st = gst_structure_new(
+      GST_PYLON_META_PARAMS_NAME, GST_PYLON_META_PARAMS_CHUNKS, G_TYPE_STRV,
+      reinterpret_cast<gchar **>(merged->pdata), NULL);
+  gst_query_add_allocation_meta(query, GST_PYLON_META_API_TYPE, st);
+
+  gst_structure_free(st);
+  g_ptr_array_free(merged, TRUE);
+  g_strfreev(requested);
+}
+
+gchar **gst_pylon_meta_parse_chunk_request(GstQuery *query) {
+  const GstStructure *params = NULL;
+  gchar **requested = NULL;
+  guint index = 0;
+
+  g_return_val_if_fail(GST_IS_QUERY(query), NULL);
+
+  if (!gst_query_find_allocation_meta(query, GST_PYLON_META_API_TYPE,
+                                      &index)) {
+    return NULL;
+  }
+
+  gst_query_parse_nth_allocation_meta(query, index, &params);
+  if (params) {
+    gst_structure_get(params, GST_PYLON_META_PARAMS_CHUNKS, G_TYPE_STRV,
+                      &requested, NULL);
+  }
+
+  return requested;
+}
@@ -42,12 +42,15 @@ G_BEGIN_DECLS
 #define GST_PYLON_META_INFO (gst_pylon_meta_get_info())
 typedef struct _GstPylonOffset GstPylonOffset;
 typedef struct _GstPylonMeta GstPylonMeta;
+typedef struct _GstPylonMetaChunks GstPylonMetaChunks;
 
 struct _GstPylonOffset {
   guint64 offset_x;
   guint64 offset_y;
 };
 
+/* The chunks field is NULL until gst_pylon_meta_get_chunks() is called on
+ * the meta, it is not filled when the buffer is produced anymore. */
 struct _GstPylonMeta {
   GstMeta meta;
 
@@ -58,11 +61,41 @@ struct _GstPylonMeta {
   GstPylonOffset offset;
   GstClockTime timestamp;
   gsize stride;
+
+  /*< private >*/
+  GstPylonMetaChunks *chunk_data;
+  gpointer _gst_reserved[GST_PADDING - 1];
 };
 
 EXT_PYLONSRC_API GType gst_pylon_meta_api_get_type(void);
 EXT_PYLONSRC_API const GstMetaInfo *gst_pylon_meta_get_info(void);
 EXT_PYLONSRC_API GstPylonMeta *gst_buffer_get_pylon_meta(GstBuffer *buffer);
 
+/* Chunks are decoded on first access. The getters return FALSE (or NULL) if
+ * the chunk is missing or of a different type. Strings and the structure
+ * stay valid as long as the buffer isn't returned to its pool. */
+EXT_PYLONSRC_API gboolean gst_pylon_meta_get_chunk_int64(
+    const GstPylonMeta *meta, const gchar *name, gint64 *value);
+EXT_PYLONSRC_API gboolean gst_pylon_meta_get_chunk_double(
+    const GstPylonMeta *meta, const gchar *name, gdouble *value);
+EXT_PYLONSRC_API gboolean gst_pylon_meta_get_chunk_boolean(
+    const GstPylonMeta *meta, const gchar *name, gboolean *value);
+EXT_PYLONSRC_API const gchar *gst_pylon_meta_get_chunk_string(
+    const GstPylonMeta *meta, const gchar *name);
+/* G_TYPE_INT64, G_TYPE_DOUBLE, G_TYPE_BOOLEAN or G_TYPE_STRING, and
+ * G_TYPE_INVALID if the chunk is missing */
+EXT_PYLONSRC_API GType gst_pylon_meta_get_chunk_type(const GstPylonMeta *meta,
+                                                     const gchar *name);
+/* Builds the chunks field on first call and returns it */
+EXT_PYLONSRC_API const GstStructure *gst_pylon_meta_get_chunks(
+    const GstPylonMeta *meta);
+
+/* Downstream elements request the chunks they need while answering the
+ * ALLOCATION query, requests of several elements are merged. pylonsrc then
+ * enables and decodes only the requested chunks. Names are chunk field
+ * names, e.g. "ChunkExposureTime" or "ChunkCounterValue-Counter1". */
+EXT_PYLONSRC_API void gst_pylon_meta_request_chunks(GstQuery *query,
+                                                    const gchar *const *chunks);
+
 G_END_DECLS
 #endif
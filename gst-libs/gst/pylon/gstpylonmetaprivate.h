@@ -38,8 +38,29 @@
 #include <gst/pylon/gstpylonincludes.h>
 #include <gst/pylon/gstpylonmeta.h>
 
+class GstPylonChunkPlan;
+
+/* The chunk plan is owned by the source and reset whenever grabbing
+ * starts */
+EXT_PYLONSRC_API GstPylonChunkPlan *gst_pylon_chunk_plan_new(void);
+EXT_PYLONSRC_API void gst_pylon_chunk_plan_free(GstPylonChunkPlan *plan);
+EXT_PYLONSRC_API void gst_pylon_chunk_plan_reset(GstPylonChunkPlan *plan);
+/* Restrict decoding to the given chunk names, NULL decodes all chunks.
+ * Applies from the next reset on. */
+EXT_PYLONSRC_API void gst_pylon_chunk_plan_set_selection(
+    GstPylonChunkPlan *plan, const gchar *const *chunks);
+
 EXT_PYLONSRC_API void gst_buffer_add_pylon_meta(
     GstBuffer *buffer,
-    const Pylon::CBaslerUniversalGrabResultPtr &grab_result_ptr);
+    const Pylon::CBaslerUniversalGrabResultPtr &grab_result_ptr,
+    GstPylonChunkPlan *chunk_plan);
+
+/* Drop the grab result kept for decoding, called when a pooled buffer is
+ * released */
+EXT_PYLONSRC_API void gst_buffer_release_pylon_meta(GstBuffer *buffer);
+
+/* Chunks requested by downstream with gst_pylon_meta_request_chunks(), NULL
+ * without a request. Free with g_strfreev(). */
+EXT_PYLONSRC_API gchar **gst_pylon_meta_parse_chunk_request(GstQuery *query);
 
 #endif
@@ -521,6 +521,20 @@ static void gst_pylon_object_get_property(GObject* object, guint property_id,
   }
 }
 
+static std::string gst_pylon_object_get_cache_filename(
+    Pylon::CBaslerUniversalInstantCamera& camera) {
+  return std::string(camera.GetDeviceInfo().GetModelName() + "_" +
+                     Pylon::GetPylonVersionString() + "_" + VERSION);
+}
+
+void gst_pylon_object_warm_cache(Pylon::CBaslerUniversalInstantCamera& camera) {
+  GstPylonCache feature_cache(gst_pylon_object_get_cache_filename(camera));
+
+  GstPylonFeatureWalker::query_limits(camera.GetNodeMap(), feature_cache);
+  GstPylonFeatureWalker::query_limits(camera.GetStreamGrabberNodeMap(),
+                                      feature_cache);
+}
+
 GObject* gst_pylon_object_new(
     std::shared_ptr<Pylon::CBaslerUniversalInstantCamera> camera,
     const std::string& device_name, GenApi::INodeMap* nodemap,
@@ -533,10 +547,8 @@ GObject* gst_pylon_object_new(
   std::unique_ptr<GstPylonCache> feature_cache;
 
   if (!type) {
-    std::string cache_filename =
-        std::string(camera->GetDeviceInfo().GetModelName() + "_" +
-                    Pylon::GetPylonVersionString() + "_" + VERSION);
-    feature_cache = std::make_unique<GstPylonCache>(cache_filename);
+    feature_cache = std::make_unique<GstPylonCache>(
+        gst_pylon_object_get_cache_filename(*camera));
     type = gst_pylon_object_register(device_name, *feature_cache, *nodemap);
   }
 
@@ -72,6 +72,12 @@ EXT_PYLONSRC_API GObject* gst_pylon_object_new(
     const std::string& device_name, GenApi::INodeMap* nodemap,
     gboolean enable_correction);
 
+/* Fills the feature cache used by gst_pylon_object_new() for the camera
+ * and its stream grabber. Creates no types, devices of different models
+ * may be handled on different threads. */
+EXT_PYLONSRC_API void gst_pylon_object_warm_cache(
+    Pylon::CBaslerUniversalInstantCamera& camera);
+
 EXT_PYLONSRC_API void gst_pylon_object_set_pylon_selector(
     GenApi::INodeMap& nodemap, const gchar* selector_name,
     gint64& selector_value);
@@ -35,6 +35,7 @@
 #include "gstpylonintrospection.h"
 #include "gstpylonparamspecs.h"
 
+#include <mutex>
 #include <unordered_map>
 
 GParamSpec *GstPylonParamFactory::gst_pylon_make_spec_int64(
@@ -164,6 +165,8 @@ GType GstPylonParamFactory::gst_pylon_make_enum_type(GenApi::INode *node) {
      we are saving all found enums into a static hash table
   */
   static std::unordered_map<GType, std::vector<GEnumValue>> persistent_values;
+  /* Elements may open devices from different threads */
+  static std::mutex persistent_values_mutex;
 
   g_return_val_if_fail(node, G_TYPE_INVALID);
 
@@ -174,6 +177,7 @@ GType GstPylonParamFactory::gst_pylon_make_enum_type(GenApi::INode *node) {
   std::string name = gst_pylon_param_spec_sanitize_name(full_name);
   g_free(full_name);
 
+  std::lock_guard<std::mutex> lock(persistent_values_mutex);
   GType type = g_type_from_name(name.c_str());
 
   if (!type) {
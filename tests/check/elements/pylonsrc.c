@@ -0,0 +1,100 @@
+/* Copyright (C) 2024 Basler AG
+ *
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *     1. Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *     2. Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *     3. Neither the name of the copyright holder nor the names of
+ *        its contributors may be used to endorse or promote products
+ *        derived from this software without specific prior written
+ *        permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include "config.h"
+#endif
+
+#include <gst/check/gstcheck.h>
+#include <gst/check/gstharness.h>
+
+/* Enough frames to reuse every grab buffer many times */
+#define NUM_FRAMES 200
+
+GST_START_TEST(test_steady_state_allocations) {
+  GstHarness *h = gst_harness_new("pylonsrc");
+  GstStructure *stats = NULL;
+  guint64 delivered = 0;
+  guint64 buffer_allocations = 0;
+  guint64 meta_allocations = 0;
+  guint64 steady_state_allocations = 0;
+
+  gst_harness_play(h);
+
+  /* Buffers go back to the pool right away, every grab buffer gets its
+   * shell and meta the first time it is used */
+  for (guint i = 0; i < NUM_FRAMES; i++) {
+    GstBuffer *buffer = gst_harness_pull(h);
+    fail_unless(buffer);
+    gst_buffer_unref(buffer);
+  }
+
+  g_object_get(h->element, "stats", &stats, NULL);
+  fail_unless(stats);
+  fail_unless(gst_structure_get_uint64(stats, "frames-delivered", &delivered));
+  fail_unless(gst_structure_get_uint64(stats, "buffer-allocations",
+                                       &buffer_allocations));
+  fail_unless(
+      gst_structure_get_uint64(stats, "meta-allocations", &meta_allocations));
+  fail_unless(gst_structure_get_uint64(stats, "steady-state-allocations",
+                                       &steady_state_allocations));
+
+  fail_unless(delivered >= NUM_FRAMES);
+  fail_unless(buffer_allocations > 0);
+  fail_unless(buffer_allocations < NUM_FRAMES);
+  fail_unless_equals_uint64(meta_allocations, buffer_allocations);
+  fail_unless_equals_uint64(steady_state_allocations, 0);
+
+  gst_structure_free(stats);
+  gst_harness_teardown(h);
+}
+
+GST_END_TEST
+
+static Suite *pylonsrc_suite(void) {
+  Suite *s = suite_create("pylonsrc");
+  TCase *tc_chain = tcase_create("general");
+
+  suite_add_tcase(s, tc_chain);
+  tcase_add_test(tc_chain, test_steady_state_allocations);
+
+  return s;
+}
+
+int main(int argc, char **argv) {
+  /* Grab from the pylon camera emulator unless told otherwise */
+  g_setenv("PYLON_CAMEMU", "1", FALSE);
+
+  gst_check_init(&argc, &argv);
+
+  return gst_check_run_suite(pylonsrc_suite(), "pylonsrc", __FILE__);
+}
@@ -0,0 +1,115 @@
+/* Copyright (C) 2024 Basler AG
+ *
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *     1. Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *     2. Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *     3. Neither the name of the copyright holder nor the names of
+ *        its contributors may be used to endorse or promote products
+ *        derived from this software without specific prior written
+ *        permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include "config.h"
+#endif
+
+#include <gst/check/gstcheck.h>
+#include <gst/pylon/gstpylongraycodewalker.h>
+
+#include <set>
+#include <vector>
+
+/* Walks all combinations and checks that each one is visited once and
+ * differs from the previous one by a single step in a single position */
+static void check_walk(const std::vector<size_t> &radices) {
+  GstPylonGrayCodeWalker walker(radices);
+  std::set<std::vector<size_t>> visited;
+  std::vector<size_t> previous(radices.size(), 0);
+  size_t expected = 1;
+
+  for (auto radix : radices) {
+    expected *= radix;
+  }
+
+  visited.insert(previous);
+  for (size_t step = walker.Next(); step < radices.size();
+       step = walker.Next()) {
+    std::vector<size_t> combination(radices.size());
+
+    for (size_t i = 0; i < radices.size(); i++) {
+      combination[i] = walker.GetValue(i);
+      fail_unless(combination[i] < radices[i]);
+      if (i != step) {
+        fail_unless_equals_uint64(combination[i], previous[i]);
+      }
+    }
+    fail_unless(combination[step] + 1 == previous[step] ||
+                combination[step] == previous[step] + 1);
+    fail_unless(visited.insert(combination).second);
+
+    previous = combination;
+  }
+
+  fail_unless_equals_uint64(visited.size(), expected);
+  /* The walk stays finished */
+  fail_unless_equals_uint64(walker.Next(), radices.size());
+}
+
+GST_START_TEST(test_binary) { check_walk({2, 2, 2, 2}); }
+
+GST_END_TEST
+
+GST_START_TEST(test_mixed_radix) {
+  check_walk({2, 3, 4});
+  check_walk({5, 2, 3, 2});
+}
+
+GST_END_TEST
+
+GST_START_TEST(test_single_position) { check_walk({7}); }
+
+GST_END_TEST
+
+GST_START_TEST(test_no_positions) {
+  GstPylonGrayCodeWalker walker({});
+
+  fail_unless_equals_uint64(walker.Next(), 0);
+}
+
+GST_END_TEST
+
+static Suite *graycodewalker_suite(void) {
+  Suite *s = suite_create("graycodewalker");
+  TCase *tc_chain = tcase_create("general");
+
+  suite_add_tcase(s, tc_chain);
+  tcase_add_test(tc_chain, test_binary);
+  tcase_add_test(tc_chain, test_mixed_radix);
+  tcase_add_test(tc_chain, test_single_position);
+  tcase_add_test(tc_chain, test_no_positions);
+
+  return s;
+}
+
+GST_CHECK_MAIN(graycodewalker)
@@ -0,0 +1,271 @@
+/* Copyright (C) 2024 Basler AG
+ *
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *     1. Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *     2. Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *     3. Neither the name of the copyright holder nor the names of
+ *        its contributors may be used to endorse or promote products
+ *        derived from this software without specific prior written
+ *        permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include "config.h"
+#endif
+
+#include <gst/check/gstcheck.h>
+#include <gst/pylon/gstpylonchunkplan.h>
+#include <gst/pylon/gstpylonmeta.h>
+
+#include <string>
+
+#define FRAME_SIZE 64
+
+/* A meta as pylonsrc produces it once its chunks are decoded, with one
+ * chunk of every type */
+static GstBuffer *create_buffer(void) {
+  GstBuffer *buffer = gst_buffer_new_allocate(NULL, FRAME_SIZE, NULL);
+  GstPylonMeta *meta = (GstPylonMeta *)gst_buffer_add_meta(
+      buffer, GST_PYLON_META_INFO, NULL);
+  GstPylonChunkValue value;
+
+  meta->block_id = 1;
+  meta->image_number = 2;
+  meta->skipped_images = 3;
+  meta->offset.offset_x = 4;
+  meta->offset.offset_y = 5;
+  meta->timestamp = G_GUINT64_CONSTANT(0x123456789abcdef0);
+  meta->stride = 8;
+
+  value.field = g_quark_from_static_string("ChunkCounterValue-Counter1");
+  value.type = G_TYPE_INT64;
+  value.int_value = G_MININT64 + 1;
+  meta->chunk_data->values.push_back(value);
+
+  value.field = g_quark_from_static_string("ChunkExposureTime");
+  value.type = G_TYPE_DOUBLE;
+  value.double_value = 1234.5;
+  meta->chunk_data->values.push_back(value);
+
+  value.field = g_quark_from_static_string("ChunkLineStatus-Line1");
+  value.type = G_TYPE_BOOLEAN;
+  value.boolean_value = TRUE;
+  meta->chunk_data->values.push_back(value);
+
+  value.field = g_quark_from_static_string("ChunkSequencerSetActive");
+  value.type = G_TYPE_STRING;
+  value.string_value = "Set1";
+  meta->chunk_data->values.push_back(value);
+
+  meta->chunk_data->decoded.store(true);
+
+  return buffer;
+}
+
+static void check_meta(const GstPylonMeta *meta) {
+  gint64 int_value = 0;
+  gdouble double_value = 0;
+  gboolean boolean_value = FALSE;
+
+  fail_unless(meta);
+  fail_unless_equals_uint64(meta->block_id, 1);
+  fail_unless_equals_uint64(meta->image_number, 2);
+  fail_unless_equals_uint64(meta->skipped_images, 3);
+  fail_unless_equals_uint64(meta->offset.offset_x, 4);
+  fail_unless_equals_uint64(meta->offset.offset_y, 5);
+  fail_unless_equals_uint64(meta->timestamp,
+                            G_GUINT64_CONSTANT(0x123456789abcdef0));
+  fail_unless_equals_uint64(meta->stride, 8);
+
+  fail_unless(gst_pylon_meta_get_chunk_int64(
+      meta, "ChunkCounterValue-Counter1", &int_value));
+  fail_unless_equals_int64(int_value, G_MININT64 + 1);
+  fail_unless(gst_pylon_meta_get_chunk_double(meta, "ChunkExposureTime",
+                                              &double_value));
+  fail_unless_equals_float(double_value, 1234.5);
+  fail_unless(gst_pylon_meta_get_chunk_boolean(meta, "ChunkLineStatus-Line1",
+                                               &boolean_value));
+  fail_unless(boolean_value);
+  fail_unless_equals_string(
+      gst_pylon_meta_get_chunk_string(meta, "ChunkSequencerSetActive"),
+      "Set1");
+}
+
+GST_START_TEST(test_copy) {
+  GstBuffer *buffer = create_buffer();
+  GstBuffer *copy = gst_buffer_copy(buffer);
+
+  check_meta(gst_buffer_get_pylon_meta(copy));
+
+  gst_buffer_unref(copy);
+  gst_buffer_unref(buffer);
+}
+
+GST_END_TEST
+
+GST_START_TEST(test_region_copy) {
+  GstBuffer *buffer = create_buffer();
+  GstBuffer *copy =
+      gst_buffer_copy_region(buffer, GST_BUFFER_COPY_ALL, 8, FRAME_SIZE - 8);
+
+  /* Offset and stride don't describe a part of the frame */
+  fail_if(gst_buffer_get_pylon_meta(copy));
+
+  gst_buffer_unref(copy);
+  gst_buffer_unref(buffer);
+}
+
+GST_END_TEST
+
+#if GST_CHECK_VERSION(1, 24, 0)
+GST_START_TEST(test_serialize) {
+  GstBuffer *buffer = create_buffer();
+  GstBuffer *target = gst_buffer_new();
+  GByteArray *data = g_byte_array_new();
+  guint32 consumed = 0;
+
+  fail_unless(gst_meta_serialize_simple(
+      (GstMeta *)gst_buffer_get_pylon_meta(buffer), data));
+
+  fail_unless(gst_meta_deserialize(target, data->data, data->len, &consumed));
+  fail_unless_equals_int(consumed, data->len);
+  check_meta(gst_buffer_get_pylon_meta(target));
+
+  g_byte_array_unref(data);
+  gst_buffer_unref(target);
+  gst_buffer_unref(buffer);
+}
+
+GST_END_TEST
+
+GST_START_TEST(test_serialize_truncated) {
+  GstBuffer *buffer = create_buffer();
+  GByteArray *data = g_byte_array_new();
+  guint32 consumed = 0;
+
+  fail_unless(gst_meta_serialize_simple(
+      (GstMeta *)gst_buffer_get_pylon_meta(buffer), data));
+
+  /* Every shorter payload has to be rejected, the header of the
+   * serialized meta holds its total size so patch it as well */
+  for (guint len = data->len - 1; len > 0; len--) {
+    GstBuffer *target = gst_buffer_new();
+    GByteArray *truncated = g_byte_array_new();
+
+    g_byte_array_append(truncated, data->data, data->len);
+    g_byte_array_set_size(truncated, len);
+    if (len >= sizeof(guint32)) {
+      GST_WRITE_UINT32_LE(truncated->data, len);
+    }
+
+    gst_meta_deserialize(target, truncated->data, truncated->len, &consumed);
+    fail_if(gst_buffer_get_pylon_meta(target));
+
+    g_byte_array_unref(truncated);
+    gst_buffer_unref(target);
+  }
+
+  g_byte_array_unref(data);
+  gst_buffer_unref(buffer);
+}
+
+GST_END_TEST
+
+GST_START_TEST(test_serialize_empty_string) {
+  GstBuffer *buffer = gst_buffer_new();
+  GstBuffer *target = gst_buffer_new();
+  GstPylonMeta *meta = (GstPylonMeta *)gst_buffer_add_meta(
+      buffer, GST_PYLON_META_INFO, NULL);
+  GByteArray *data = g_byte_array_new();
+  GstPylonChunkValue value;
+  guint32 consumed = 0;
+
+  /* The smallest chunk there is, an empty name with an empty string */
+  value.field = g_quark_from_static_string("");
+  value.type = G_TYPE_STRING;
+  meta->chunk_data->values.push_back(value);
+  meta->chunk_data->decoded.store(true);
+
+  fail_unless(gst_meta_serialize_simple((GstMeta *)meta, data));
+  fail_unless(gst_meta_deserialize(target, data->data, data->len, &consumed));
+  fail_unless_equals_string(
+      gst_pylon_meta_get_chunk_string(gst_buffer_get_pylon_meta(target), ""),
+      "");
+
+  g_byte_array_unref(data);
+  gst_buffer_unref(target);
+  gst_buffer_unref(buffer);
+}
+
+GST_END_TEST
+
+GST_START_TEST(test_serialize_long_name) {
+  GstBuffer *buffer = create_buffer();
+  GstBuffer *target = gst_buffer_new();
+  GstPylonMeta *meta = gst_buffer_get_pylon_meta(buffer);
+  GByteArray *data = g_byte_array_new();
+  std::string name(1024, 'x');
+  GstPylonChunkValue value;
+  guint32 consumed = 0;
+
+  /* Too long to be interned by the receiver, the other chunks are kept */
+  value.field = g_quark_from_string(name.c_str());
+  value.type = G_TYPE_INT64;
+  value.int_value = 1;
+  meta->chunk_data->values.push_back(value);
+
+  fail_unless(gst_meta_serialize_simple((GstMeta *)meta, data));
+  fail_unless(gst_meta_deserialize(target, data->data, data->len, &consumed));
+  check_meta(gst_buffer_get_pylon_meta(target));
+  fail_unless_equals_int(
+      gst_pylon_meta_get_chunk_type(gst_buffer_get_pylon_meta(target),
+                                    name.c_str()),
+      G_TYPE_INVALID);
+
+  g_byte_array_unref(data);
+  gst_buffer_unref(target);
+  gst_buffer_unref(buffer);
+}
+
+GST_END_TEST
+#endif
+
+static Suite *pylonmeta_suite(void) {
+  Suite *s = suite_create("pylonmeta");
+  TCase *tc_chain = tcase_create("general");
+
+  suite_add_tcase(s, tc_chain);
+  tcase_add_test(tc_chain, test_copy);
+  tcase_add_test(tc_chain, test_region_copy);
+#if GST_CHECK_VERSION(1, 24, 0)
+  tcase_add_test(tc_chain, test_serialize);
+  tcase_add_test(tc_chain, test_serialize_truncated);
+  tcase_add_test(tc_chain, test_serialize_empty_string);
+  tcase_add_test(tc_chain, test_serialize_long_name);
+#endif
+
+  return s;
+}
+
+GST_CHECK_MAIN(pylonmeta)
@@ -0,0 +1,166 @@
+/* Copyright (C) 2024 Basler AG
+ *
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *     1. Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *     2. Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *     3. Neither the name of the copyright holder nor the names of
+ *        its contributors may be used to endorse or promote products
+ *        derived from this software without specific prior written
+ *        permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include "config.h"
+#endif
+
+#include <gst/check/gstcheck.h>
+
+#include "ext/pylon/gstpylontimestampmapper.h"
+
+/* Clock times this large can't be held exactly by a double */
+#define BASE_TIME (G_GUINT64_CONSTANT(1) << 62)
+#define BASE_TICKS G_GUINT64_CONSTANT(123456789012345)
+#define FRAME_TICKS 1000000
+
+GST_START_TEST(test_needs_two_samples) {
+  GstPylonTimestampMapper mapper(8);
+  GstClockTime time = GST_CLOCK_TIME_NONE;
+
+  fail_if(mapper.Map(BASE_TICKS, time));
+
+  mapper.AddSample(BASE_TICKS, BASE_TIME);
+  fail_if(mapper.Map(BASE_TICKS, time));
+
+  mapper.AddSample(BASE_TICKS + FRAME_TICKS, BASE_TIME + FRAME_TICKS);
+  fail_unless(mapper.Map(BASE_TICKS, time));
+  fail_unless_equals_uint64(time, BASE_TIME);
+}
+
+GST_END_TEST
+
+GST_START_TEST(test_exact_fit) {
+  GstPylonTimestampMapper mapper(8);
+  GstClockTime time = GST_CLOCK_TIME_NONE;
+
+  /* More samples than the window holds, the oldest ones are replaced */
+  for (guint64 i = 0; i < 20; i++) {
+    mapper.AddSample(BASE_TICKS + i * FRAME_TICKS, BASE_TIME + i * 1000000);
+  }
+
+  /* Interpolated, extrapolated and before the first sample */
+  fail_unless(mapper.Map(BASE_TICKS + 15 * FRAME_TICKS + 1, time));
+  fail_unless_equals_uint64(time, BASE_TIME + 15 * 1000000 + 1);
+  fail_unless(mapper.Map(BASE_TICKS + 100 * FRAME_TICKS + 7, time));
+  fail_unless_equals_uint64(time, BASE_TIME + 100 * 1000000 + 7);
+  fail_unless(mapper.Map(BASE_TICKS - 3, time));
+  fail_unless_equals_uint64(time, BASE_TIME - 3);
+}
+
+GST_END_TEST
+
+GST_START_TEST(test_drift) {
+  GstPylonTimestampMapper mapper(32);
+  GstClockTime time = GST_CLOCK_TIME_NONE;
+
+  /* The camera clock runs 100 ppm slow */
+  for (guint64 i = 0; i < 32; i++) {
+    mapper.AddSample(BASE_TICKS + i * FRAME_TICKS,
+                     BASE_TIME + i * (FRAME_TICKS + 100));
+  }
+
+  fail_unless(mapper.Map(BASE_TICKS + 1000 * FRAME_TICKS, time));
+  fail_unless_equals_uint64(time, BASE_TIME + 1000 * (FRAME_TICKS + 100));
+}
+
+GST_END_TEST
+
+GST_START_TEST(test_jitter) {
+  GstPylonTimestampMapper mapper(64);
+  GstClockTime time = GST_CLOCK_TIME_NONE;
+
+  /* Alternating jitter averages out */
+  for (guint64 i = 0; i < 64; i++) {
+    GstClockTime jitter = i % 2 ? 2000 : 0;
+    mapper.AddSample(BASE_TICKS + i * FRAME_TICKS,
+                     BASE_TIME + i * FRAME_TICKS + jitter);
+  }
+
+  fail_unless(mapper.Map(BASE_TICKS + 32 * FRAME_TICKS, time));
+  fail_unless(time >= BASE_TIME + 32 * FRAME_TICKS + 900);
+  fail_unless(time <= BASE_TIME + 32 * FRAME_TICKS + 1100);
+}
+
+GST_END_TEST
+
+GST_START_TEST(test_discontinuity) {
+  GstPylonTimestampMapper mapper(8);
+  GstClockTime time = GST_CLOCK_TIME_NONE;
+
+  for (guint64 i = 0; i < 8; i++) {
+    mapper.AddSample(BASE_TICKS + i * FRAME_TICKS, BASE_TIME + i * FRAME_TICKS);
+  }
+
+  /* The camera timestamp was reset, the fit starts over */
+  mapper.AddSample(0, BASE_TIME + 8 * FRAME_TICKS);
+  fail_if(mapper.Map(0, time));
+
+  mapper.AddSample(FRAME_TICKS, BASE_TIME + 9 * FRAME_TICKS);
+  fail_unless(mapper.Map(2 * FRAME_TICKS, time));
+  fail_unless_equals_uint64(time, BASE_TIME + 10 * FRAME_TICKS);
+}
+
+GST_END_TEST
+
+GST_START_TEST(test_invalid_time) {
+  GstPylonTimestampMapper mapper(8);
+  GstClockTime time = GST_CLOCK_TIME_NONE;
+
+  mapper.AddSample(BASE_TICKS, GST_CLOCK_TIME_NONE);
+  mapper.AddSample(BASE_TICKS + FRAME_TICKS, GST_CLOCK_TIME_NONE);
+  fail_if(mapper.Map(BASE_TICKS, time));
+
+  /* Mapped times can't be negative */
+  mapper.AddSample(BASE_TICKS, 0);
+  mapper.AddSample(BASE_TICKS + FRAME_TICKS, FRAME_TICKS);
+  fail_if(mapper.Map(BASE_TICKS - 1, time));
+}
+
+GST_END_TEST
+
+static Suite *timestampmapper_suite(void) {
+  Suite *s = suite_create("timestampmapper");
+  TCase *tc_chain = tcase_create("general");
+
+  suite_add_tcase(s, tc_chain);
+  tcase_add_test(tc_chain, test_needs_two_samples);
+  tcase_add_test(tc_chain, test_exact_fit);
+  tcase_add_test(tc_chain, test_drift);
+  tcase_add_test(tc_chain, test_jitter);
+  tcase_add_test(tc_chain, test_discontinuity);
+  tcase_add_test(tc_chain, test_invalid_time);
+
+  return s;
+}
+
+GST_CHECK_MAIN(timestampmapper)
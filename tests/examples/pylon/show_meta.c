@@ -158,6 +158,7 @@ static GstPadProbeReturn cb_have_data(GstPad *pad, GstPadProbeInfo *info,
   Context *ctx = (Context *)user_data;
   gchar *meta_str = NULL;
   gchar *tmp_str = NULL;
+  const GstStructure *chunks = NULL;
   gint64 int_chunk;
   gdouble double_chunk;
 
@@ -173,19 +174,20 @@ static GstPadProbeReturn cb_have_data(GstPad *pad, GstPadProbeInfo *info,
       meta->offset.offset_x, meta->offset.offset_y, meta->timestamp);
 
   /* show chunks embedded in the stream */
-  for (int idx = 0; idx < gst_structure_n_fields(meta->chunks); idx++) {
-    const gchar *chunk_name = gst_structure_nth_field_name(meta->chunks, idx);
-    GType chunk_type = gst_structure_get_field_type(meta->chunks, chunk_name);
+  chunks = gst_pylon_meta_get_chunks(meta);
+  for (int idx = 0; idx < gst_structure_n_fields(chunks); idx++) {
+    const gchar *chunk_name = gst_structure_nth_field_name(chunks, idx);
+    GType chunk_type = gst_structure_get_field_type(chunks, chunk_name);
     /* display double and int types */
     switch (chunk_type) {
       case G_TYPE_INT64:
-        gst_structure_get_int64(meta->chunks, chunk_name, &int_chunk);
+        gst_structure_get_int64(chunks, chunk_name, &int_chunk);
         tmp_str = g_strdup_printf("%s%s_%ld ", meta_str, chunk_name, int_chunk);
         g_free(meta_str);
         meta_str = tmp_str;
         break;
       case G_TYPE_DOUBLE:
-        gst_structure_get_double(meta->chunks, chunk_name, &double_chunk);
+        gst_structure_get_double(chunks, chunk_name, &double_chunk);
         tmp_str =
             g_strdup_printf("%s%s_%.2f ", meta_str, chunk_name, double_chunk);
         g_free(meta_str);